@@ -30,6 +30,7 @@
 #include "accountcreationwizard.h"
 #include "usernameregistrationbox.h"
 #include "utils/files.h"
+#include "utils/styleregistry.h"
 
 struct _AccountCreationWizard
 {
@@ -1041,17 +1042,7 @@ build_creation_wizard_view(AccountCreationWizard *view)
 
     gtk_button_set_relief(GTK_BUTTON(priv->button_show_advanced), GTK_RELIEF_NONE);
 
-    auto provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider,
-        ".black { color: grey; font-size: 0.8em; }\
-        .transparent-button { margin-left: 0; border: 0; background-color: rgba(0,0,0,0); margin-right: 0; padding-right: 0;}\
-        .infos-button { margin: 0; border: 0; background-color: rgba(0,0,0,0); padding: 0; box-shadow: 0;}\
-        .smaller {font-size: 0.87em;}",
-        -1, nullptr
-    );
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/accountcreationwizard.css");
 }
 
 GtkWidget *
@@ -35,6 +35,7 @@
 // Jami  Client
 #include "accountmigrationview.h"
 #include "utils/drawing.h"
+#include "utils/styleregistry.h"
 
 /* size of avatar */
 static constexpr int AVATAR_WIDTH  = 150; /* px */
@@ -258,13 +259,7 @@ build_migration_view(AccountMigrationView *view)
     g_object_unref(photo);
 
     // CSS styles
-    auto provider = gtk_css_provider_new();
-    std::string css = ".button_red { color: white; background: #dc3a37; border: 0; }";
-    css += ".button_red:hover { background: #dc2719; }";
-    gtk_css_provider_load_from_data(provider, css.c_str(), -1, nullptr);
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/accountmigrationview.css");
     GtkStyleContext* context;
     context = gtk_widget_get_style_context(GTK_WIDGET(priv->button_delete_account));
     gtk_style_context_add_class(context, "button_red");
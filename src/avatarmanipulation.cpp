@@ -27,6 +27,7 @@
 
 /* client */
 #include "utils/drawing.h"
+#include "video/camerapreview.h"
 #include "video/video_widget.h"
 #include "cc-crop-area.h"
 
@@ -83,11 +84,10 @@ struct _AvatarManipulationPrivate
     AvatarManipulationState state;
     AvatarManipulationState last_state;
 
-    /* this is used to keep track of the state of the preview when the camera is used to take a
-     * photo; if a call is in progress, then the preview should already be started and we don't want
-     * to stop it when the settings are closed, in this case
+    /* the preview used when the camera is used to take a photo, shared with the calls and the
+     * other views showing it
      */
-    gboolean video_started_by_avatar_manipulation;
+    gchar* camera_preview;
 
     QMetaObject::Connection local_renderer_connection;
 
@@ -117,8 +117,7 @@ avatar_manipulation_dispose(GObject *object)
     AvatarManipulationPrivate *priv = AVATAR_MANIPULATION_GET_PRIVATE(object);
 
     /* make sure we stop the preview and the video widget */
-    if (priv->video_started_by_avatar_manipulation)
-        priv->avModel_->stopPreview("camera://" + priv->avModel_->getDefaultDevice());
+    camera_preview_release(&priv->camera_preview);
     if (priv->video_widget) {
         gtk_container_remove(GTK_CONTAINER(priv->frame_video), priv->video_widget);
         priv->video_widget = NULL;
@@ -263,10 +262,8 @@ set_state(AvatarManipulation *self, AvatarManipulationState state)
             gtk_widget_set_visible(priv->button_box_edit,    false);
 
             /* make sure video widget and camera is not running */
-            if (priv->video_started_by_avatar_manipulation) {
-                priv->avModel_->stopPreview("camera://" + priv->avModel_->getDefaultDevice());
-                QObject::disconnect(priv->local_renderer_connection);
-            }
+            camera_preview_release(&priv->camera_preview);
+            QObject::disconnect(priv->local_renderer_connection);
             if (priv->video_widget) {
                 gtk_container_remove(GTK_CONTAINER(priv->frame_video), priv->video_widget);
                 priv->video_widget = NULL;
@@ -291,15 +288,13 @@ set_state(AvatarManipulation *self, AvatarManipulationState state)
                 prenderer = &priv->avModel_->getRenderer("camera://" + priv->avModel_->getDefaultDevice());
             } catch (const std::out_of_range& e) {}
 
-            priv->video_started_by_avatar_manipulation =
-                prenderer && prenderer->isRendering();
-            if (priv->video_started_by_avatar_manipulation) {
+            if (prenderer && prenderer->isRendering()) {
                 video_widget_add_new_renderer(
                     VIDEO_WIDGET(priv->video_widget),
                     priv->avModel_, prenderer,
                     VIDEO_RENDERER_REMOTE);
             } else {
-                priv->video_started_by_avatar_manipulation = true;
+                QObject::disconnect(priv->local_renderer_connection);
                 priv->local_renderer_connection = QObject::connect(
                     &*priv->avModel_,
                     &lrc::api::AVModel::rendererStarted,
@@ -317,8 +312,9 @@ set_state(AvatarManipulation *self, AvatarManipulationState state)
                             g_warning("Cannot start preview");
                         }
                     });
-                priv->avModel_->startPreview("camera://" + priv->avModel_->getDefaultDevice());
             }
+            camera_preview_release(&priv->camera_preview);
+            priv->camera_preview = camera_preview_acquire(*priv->avModel_);
 
             /* available actions: take snapshot, return*/
             gtk_widget_set_visible(priv->button_box_current, false);
@@ -329,8 +325,7 @@ set_state(AvatarManipulation *self, AvatarManipulationState state)
         case AVATAR_MANIPULATION_STATE_EDIT:
         {
             /* make sure video widget and camera is not running */
-            if (priv->video_started_by_avatar_manipulation)
-                priv->avModel_->stopPreview("camera://" + priv->avModel_->getDefaultDevice());
+            camera_preview_release(&priv->camera_preview);
             if (priv->video_widget) {
                 gtk_container_remove(GTK_CONTAINER(priv->frame_video), priv->video_widget);
                 priv->video_widget = NULL;
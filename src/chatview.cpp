@@ -26,6 +26,7 @@
 // std
 #include <algorithm>
 #include <fstream>
+#include <map>
 #include <sstream>
 
 // GTK
@@ -51,12 +52,25 @@
 #include "marshals.h"
 #include "utils/drawing.h"
 #include "utils/files.h"
+#include "utils/messageindex.h"
+#include "utils/styleregistry.h"
+#include "video/camerapreview.h"
 #include "video/video_widget.h"
 
 /* size of avatar */
 static constexpr int AVATAR_WIDTH  = 150; /* px */
 static constexpr int AVATAR_HEIGHT = 150; /* px */
 #define PLUGIN_ICON_SIZE 25
+/* messages requested at once when looking for a search result */
+static constexpr int SEARCH_LOAD_PAGE = 100;
+/* messages given back to the webview when scrolling over evicted history */
+static constexpr int HISTORY_PAGE = 50;
+/* "composing" is sent again after this long, so peers don't expire it */
+static constexpr gint64 COMPOSING_REFRESH_US = 8 * G_USEC_PER_SEC;
+/* "stopped" is sent after this long without typing */
+static constexpr gint64 COMPOSING_IDLE_US = 5 * G_USEC_PER_SEC;
+/* incoming typing indications are applied to the view at most this often */
+static constexpr guint PEERS_COMPOSING_FLUSH_MS = 300;
 
 class CppImpl;
 
@@ -76,6 +90,11 @@ struct _ChatViewPrivate
 {
     GtkWidget *box_webkit_chat_container;
     GtkWidget *webkit_chat_container;
+    GtkWidget *search_bar;
+    GtkWidget *search_entry;
+    GtkWidget *label_search_results;
+    GtkWidget *button_search_previous;
+    GtkWidget *button_search_next;
 
     GSettings *settings;
 
@@ -103,6 +122,7 @@ struct _ChatViewPrivate
     CppImpl* cpp;
 
     bool video_started_by_settings;
+    gchar* camera_preview; // shown by the video recorder
     GtkWidget* video_widget;
     GtkWidget* record_popover;
     GtkWidget* plugin_handlers_popover;
@@ -143,11 +163,40 @@ public:
     // store current recording location
     std::string saveFileName_;
 
+    // in-conversation search
+    std::vector<std::string> searchResults_;
+    std::size_t searchPos_ {0};
+    std::string pendingJump_;
+    std::string recenteredJump_;
+
+    // typing indication
+    bool typingIndication_ {true};
+    bool composing_ {false};
+    gint64 lastComposingSent_ {0};
+    gint64 lastTyped_ {0};
+    guint composingTimeout_ {0};
+    gulong typingIndicationChanged_ {0};
+    std::map<std::string, bool> peersComposing_;
+    std::map<std::string, bool> peersComposingShown_;
+    guint peersComposingSource_ {0};
+
     ChatView* self = nullptr;
     ChatViewPrivate* widgets = nullptr;
 
     void updatePluginList();
     void add_chat_handler(lrc::api::plugin::PluginHandlerDetails);
+
+    void search(const std::string& query);
+    void showSearchResult(std::size_t pos);
+
+    void setComposing(bool composing);
+    void sendComposing(bool composing);
+    void peerComposing(const std::string& contactUri, bool composing);
+    void setTypingIndication(bool enabled);
+    void stopTypingIndication();
+
+    static gboolean onComposingIdle(gpointer data);
+    static gboolean onFlushPeersComposing(gpointer data);
 };
 
 CppImpl::CppImpl(ChatView& widget)
@@ -234,6 +283,161 @@ CppImpl::updatePluginList()
     }
 }
 
+void
+CppImpl::search(const std::string& query)
+{
+    auto& store = MessageIndexStore::forAccount((*widgets->accountInfo_)->id.toStdString());
+    searchResults_ = store.searchConversation(widgets->conversation_->uid.toStdString(), query);
+    pendingJump_.clear();
+
+    if (query.empty()) {
+        gtk_label_set_text(GTK_LABEL(widgets->label_search_results), "");
+    } else if (searchResults_.empty() && !store.ready()) {
+        gtk_label_set_text(GTK_LABEL(widgets->label_search_results), _("Indexing…"));
+    } else if (searchResults_.empty()) {
+        gtk_label_set_text(GTK_LABEL(widgets->label_search_results), _("No results"));
+    } else {
+        showSearchResult(0);
+        return;
+    }
+    gtk_widget_set_sensitive(widgets->button_search_previous, FALSE);
+    gtk_widget_set_sensitive(widgets->button_search_next, FALSE);
+}
+
+void
+CppImpl::showSearchResult(std::size_t pos)
+{
+    if (pos >= searchResults_.size())
+        return;
+    searchPos_ = pos;
+
+    auto* text = g_strdup_printf(_("%zu of %zu"), searchPos_ + 1, searchResults_.size());
+    gtk_label_set_text(GTK_LABEL(widgets->label_search_results), text);
+    g_free(text);
+    gtk_widget_set_sensitive(widgets->button_search_previous, searchPos_ > 0);
+    gtk_widget_set_sensitive(widgets->button_search_next, searchPos_ + 1 < searchResults_.size());
+
+    recenteredJump_.clear();
+    webkit_chat_container_scroll_to_interaction(
+        WEBKIT_CHAT_CONTAINER(widgets->webkit_chat_container),
+        searchResults_[searchPos_]);
+}
+
+void
+CppImpl::setComposing(bool composing)
+{
+    if (!typingIndication_ || !widgets->conversation_)
+        return;
+    if (!composing) {
+        if (composing_)
+            sendComposing(false);
+        return;
+    }
+    lastTyped_ = g_get_monotonic_time();
+    if (!composing_ || lastTyped_ - lastComposingSent_ >= COMPOSING_REFRESH_US)
+        sendComposing(true);
+}
+
+void
+CppImpl::sendComposing(bool composing)
+{
+    composing_ = composing;
+    if (composing) {
+        lastComposingSent_ = g_get_monotonic_time();
+        if (!composingTimeout_)
+            composingTimeout_ = g_timeout_add(COMPOSING_IDLE_US / 1000, onComposingIdle, this);
+    } else if (composingTimeout_) {
+        g_source_remove(composingTimeout_);
+        composingTimeout_ = 0;
+    }
+    if (*widgets->accountInfo_)
+        (*widgets->accountInfo_)->conversationModel->setIsComposing(widgets->conversation_->uid, composing);
+}
+
+gboolean
+CppImpl::onComposingIdle(gpointer data)
+{
+    auto* cpp = static_cast<CppImpl*>(data);
+    cpp->composingTimeout_ = 0;
+    auto idle = g_get_monotonic_time() - cpp->lastTyped_;
+    if (idle >= COMPOSING_IDLE_US)
+        cpp->sendComposing(false);
+    else
+        cpp->composingTimeout_ = g_timeout_add((COMPOSING_IDLE_US - idle) / 1000, onComposingIdle, cpp);
+    return G_SOURCE_REMOVE;
+}
+
+void
+CppImpl::peerComposing(const std::string& contactUri, bool composing)
+{
+    if (!typingIndication_)
+        return;
+    // busy group chats send a lot of these, only keep the last state of each peer
+    peersComposing_[contactUri] = composing;
+    if (!peersComposingSource_)
+        peersComposingSource_ = g_timeout_add(PEERS_COMPOSING_FLUSH_MS, onFlushPeersComposing, this);
+}
+
+gboolean
+CppImpl::onFlushPeersComposing(gpointer data)
+{
+    auto* cpp = static_cast<CppImpl*>(data);
+    cpp->peersComposingSource_ = 0;
+    for (const auto& [contactUri, composing] : cpp->peersComposing_) {
+        auto& shown = cpp->peersComposingShown_[contactUri];
+        if (shown == composing)
+            continue;
+        shown = composing;
+        if (cpp->widgets->webkit_chat_container)
+            webkit_chat_set_is_composing(
+                WEBKIT_CHAT_CONTAINER(cpp->widgets->webkit_chat_container),
+                contactUri, composing);
+    }
+    cpp->peersComposing_.clear();
+    return G_SOURCE_REMOVE;
+}
+
+void
+CppImpl::setTypingIndication(bool enabled)
+{
+    if (typingIndication_ == enabled)
+        return;
+    if (!enabled) {
+        setComposing(false);
+        // hide the indicators currently displayed
+        for (const auto& peer : peersComposingShown_)
+            if (peer.second)
+                peersComposing_[peer.first] = false;
+        if (!peersComposing_.empty() && !peersComposingSource_)
+            peersComposingSource_ = g_idle_add(onFlushPeersComposing, this);
+    }
+    typingIndication_ = enabled;
+}
+
+void
+CppImpl::stopTypingIndication()
+{
+    if (composing_)
+        sendComposing(false);
+    if (peersComposingSource_) {
+        g_source_remove(peersComposingSource_);
+        peersComposingSource_ = 0;
+    }
+    peersComposing_.clear();
+    if (typingIndicationChanged_) {
+        g_signal_handler_disconnect(widgets->settings, typingIndicationChanged_);
+        typingIndicationChanged_ = 0;
+    }
+}
+
+static void
+on_typing_indication_changed(GSettings* settings, const gchar* key, ChatView* self)
+{
+    auto* priv = CHAT_VIEW_GET_PRIVATE(self);
+    if (priv->cpp)
+        priv->cpp->setTypingIndication(g_settings_get_boolean(settings, key));
+}
+
 enum {
     NEW_MESSAGES_DISPLAYED,
     HIDE_VIEW_CLICKED,
@@ -267,6 +471,10 @@ chat_view_dispose(GObject *object)
     QObject::disconnect(priv->interaction_removed);
     QObject::disconnect(priv->update_add_to_conversations);
     QObject::disconnect(priv->local_renderer_connection);
+    camera_preview_release(&priv->camera_preview);
+
+    if (priv->cpp)
+        priv->cpp->stopTypingIndication();
 
     /* Destroying the box will also destroy its children, and we wouldn't
      * want that. So we remove the webkit_chat_container from the box. */
@@ -436,7 +644,7 @@ on_record_closed(GtkPopover*, ChatView *self)
     priv->cpp->current_action_ = RecordAction::RECORD;
     if (priv->timer_duration) g_source_remove(priv->timer_duration);
     if (priv->is_video_record) {
-        priv->cpp->avModel_->stopPreview("camera://" + priv->cpp->avModel_->getDefaultDevice());
+        camera_preview_release(&priv->camera_preview);
         QObject::disconnect(priv->local_renderer_connection);
     }
     priv->duration = 0;
@@ -458,7 +666,7 @@ init_control_box_buttons(ChatView *self, GtkWidget *box_contols) {
     gtk_button_set_image(GTK_BUTTON(priv->button_retry), image_retry);
     gtk_widget_set_size_request(GTK_WIDGET(priv->button_retry), 48, 48);
     auto context = gtk_widget_get_style_context(GTK_WIDGET(priv->button_retry));
-    gtk_style_context_add_class(context, "record-button");
+    gtk_style_context_add_class(context, "recorder-button");
     g_signal_connect_swapped(priv->button_retry, "clicked", G_CALLBACK(reset_recorder), self);
     gtk_container_add(GTK_CONTAINER(box_contols), priv->button_retry);
 
@@ -468,7 +676,7 @@ init_control_box_buttons(ChatView *self, GtkWidget *box_contols) {
     gtk_button_set_image(GTK_BUTTON(priv->button_main_action), image_record);
     gtk_widget_set_size_request(GTK_WIDGET(priv->button_main_action), 48, 48);
     context = gtk_widget_get_style_context(GTK_WIDGET(priv->button_main_action));
-    gtk_style_context_add_class(context, "record-button");
+    gtk_style_context_add_class(context, "recorder-button");
     g_signal_connect_swapped(priv->button_main_action, "clicked", G_CALLBACK(on_main_action_clicked), self);
     gtk_container_add(GTK_CONTAINER(box_contols), priv->button_main_action);
 
@@ -483,21 +691,17 @@ chat_view_show_recorder(ChatView *self, int pt_x, int pt_y, bool is_video_record
     if (!priv->readyToRecord_) return;
 
     priv->is_video_record = is_video_record;
+    camera_preview_release(&priv->camera_preview);
     if (is_video_record)
-      priv->cpp->avModel_->startPreview("camera://" + priv->cpp->avModel_->getDefaultDevice());
-    std::string css = is_video_record ? ".record-button { background: rgba(0, 0, 0, 0.2); border-radius: 50%; border: 0; transition: all 0.3s ease; } \
-        .record-button:hover { background: rgba(0, 0, 0, 0.2); border-radius: 50%; border: 0; transition: all 0.3s ease; } \
+        priv->camera_preview = camera_preview_acquire(*priv->cpp->avModel_);
+    std::string css = is_video_record ? ".recorder-button { background: rgba(0, 0, 0, 0.2); border-radius: 50%; border: 0; transition: all 0.3s ease; } \
+        .recorder-button:hover { background: rgba(0, 0, 0, 0.2); border-radius: 50%; border: 0; transition: all 0.3s ease; } \
         .label_time { color: white; }"
-        : ".record-button { background: transparent; border-radius: 50%; border: 0; transition: all 0.3s ease; } \
-        .record-button:hover { background: transparent; border-radius: 50%; border: 0; transition: all 0.3s ease; }";
-    if (is_video_record) css += "";
+        : ".recorder-button { background: transparent; border-radius: 50%; border: 0; transition: all 0.3s ease; } \
+        .recorder-button:hover { background: transparent; border-radius: 50%; border: 0; transition: all 0.3s ease; }";
 
     // CSS styles
-    auto provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider, css.c_str(), -1, nullptr);
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_set("chatview-recorder", css);
 
 #if GTK_CHECK_VERSION(3,22,0)
     GdkRectangle workarea = {};
@@ -875,10 +1079,8 @@ webkit_chat_container_script_dialog(GtkWidget* webview, gchar *interaction, Chat
         }
     } else if (order.find("ON_COMPOSING:") == 0) {
         auto composing = order.substr(std::string("ON_COMPOSING:").size()) == "true";
-        if (!priv->conversation_) return;
-        if (g_settings_get_boolean(priv->settings, "enable-typing-indication")) {
-            (*priv->accountInfo_)->conversationModel->setIsComposing(priv->conversation_->uid, composing);
-        }
+        if (priv->cpp)
+            priv->cpp->setComposing(composing);
     } else if (order.find("LIST_PLUGIN_HANDLERS:") == 0) {
         auto pos_str {order.substr(std::string("LIST_PLUGIN_HANDLERS:").size())};
         auto sep_idx = pos_str.find("x");
@@ -896,6 +1098,60 @@ webkit_chat_container_script_dialog(GtkWidget* webview, gchar *interaction, Chat
         load_messages(*(*priv->accountInfo_)->conversationModel,
                       priv->conversation_->uid,
                       n);
+    } else if (order.find("PAGE_HISTORY:") == 0) {
+        // PAGE_HISTORY:(older|newer):<first or last displayed interaction>
+        auto request = order.substr(std::string("PAGE_HISTORY:").size());
+        auto sep_idx = request.find(":");
+        if (sep_idx == std::string::npos)
+            return;
+        auto *convModel = (*priv->accountInfo_)->conversationModel.get();
+        auto convOpt = convModel->getConversationForUid(priv->conversation_->uid);
+        if (!convOpt)
+            return;
+        webkit_chat_container_page_history(
+            WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container),
+            *convModel,
+            priv->conversation_->uid,
+            convOpt->get().interactions,
+            QString::fromStdString(request.substr(sep_idx + 1)),
+            request.substr(0, sep_idx) == "older",
+            HISTORY_PAGE,
+            convOpt->get().allMessagesLoaded);
+    } else if (order.find("SEARCH_RESULT_NOT_LOADED:") == 0) {
+        auto interactionId = order.substr(std::string("SEARCH_RESULT_NOT_LOADED:").size());
+        auto *convModel = (*priv->accountInfo_)->conversationModel.get();
+        auto convOpt = convModel->getConversationForUid(priv->conversation_->uid);
+        if (!convOpt)
+            return;
+        auto& interactions = convOpt->get().interactions;
+        if (interactions->find(QString::fromStdString(interactionId)) != interactions->end()) {
+            // the result was evicted from the webview, display the messages around it
+            if (priv->cpp->recenteredJump_ == interactionId) {
+                // already displayed around it, the message can't be shown
+                priv->cpp->recenteredJump_.clear();
+                return;
+            }
+            priv->cpp->recenteredJump_ = interactionId;
+            webkit_chat_container_page_around(
+                WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container),
+                *convModel,
+                priv->conversation_->uid,
+                interactions,
+                QString::fromStdString(interactionId),
+                HISTORY_PAGE,
+                convOpt->get().allMessagesLoaded);
+            webkit_chat_container_scroll_to_interaction(
+                WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container),
+                interactionId);
+            return;
+        }
+        // the result is older than the loaded history, page back until we reach it
+        if (!convOpt->get().isSwarm() || convOpt->get().allMessagesLoaded)
+            return;
+        priv->cpp->pendingJump_ = interactionId;
+        load_messages(*(*priv->accountInfo_)->conversationModel,
+                      priv->conversation_->uid,
+                      SEARCH_LOAD_PAGE);
     }
 }
 
@@ -919,6 +1175,11 @@ chat_view_class_init(ChatViewClass *klass)
     gtk_widget_class_bind_template_child_private(GTK_WIDGET_CLASS (klass), ChatView, box_webkit_chat_container);
     gtk_widget_class_bind_template_child_private(GTK_WIDGET_CLASS (klass), ChatView, plugin_handlers_popover);
     gtk_widget_class_bind_template_child_private(GTK_WIDGET_CLASS (klass), ChatView, list_chat_handlers_available);
+    gtk_widget_class_bind_template_child_private(GTK_WIDGET_CLASS (klass), ChatView, search_bar);
+    gtk_widget_class_bind_template_child_private(GTK_WIDGET_CLASS (klass), ChatView, search_entry);
+    gtk_widget_class_bind_template_child_private(GTK_WIDGET_CLASS (klass), ChatView, label_search_results);
+    gtk_widget_class_bind_template_child_private(GTK_WIDGET_CLASS (klass), ChatView, button_search_previous);
+    gtk_widget_class_bind_template_child_private(GTK_WIDGET_CLASS (klass), ChatView, button_search_next);
 
     chat_view_signals[NEW_MESSAGES_DISPLAYED] = g_signal_new (
         "new-interactions-displayed",
@@ -1084,6 +1345,9 @@ webkit_chat_container_ready(ChatView* self)
         WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container)
     );
     webkit_chat_set_is_swarm(WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container), priv->conversation_->isSwarm());
+    webkit_chat_container_set_resident_limit(
+        WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container),
+        std::max(g_settings_get_int(priv->settings, "chat-resident-messages"), 0));
 
     auto *convModel = (*priv->accountInfo_)->conversationModel.get();
     auto optConv = convModel->getConversationForUid(priv->conversation_->uid);
@@ -1105,6 +1369,13 @@ webkit_chat_container_ready(ChatView* self)
     webkit_chat_set_dark_mode(WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container), priv->useDarkTheme, priv->background);
 
     priv->ready_ = true;
+    if (!priv->cpp->pendingJump_.empty()) {
+        auto interactionId = std::move(priv->cpp->pendingJump_);
+        priv->cpp->pendingJump_.clear();
+        webkit_chat_container_scroll_to_interaction(
+            WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container),
+            interactionId);
+    }
     for (const auto& interaction: priv->cpp->interactionsBuffer_) {
         if (interaction.conv == priv->conversation_->uid) {
             print_interaction_to_buffer(self, priv->conversation_->uid, interaction.id, interaction.info);
@@ -1142,6 +1413,15 @@ webkit_chat_container_ready(ChatView* self)
                 conversationId,
                 optConv->get().interactions,
                 optConv->get().allMessagesLoaded);
+            if (!priv->conversation_ || conversationId != priv->conversation_->uid)
+                return;
+            if (!priv->cpp->pendingJump_.empty()) {
+                auto interactionId = std::move(priv->cpp->pendingJump_);
+                priv->cpp->pendingJump_.clear();
+                webkit_chat_container_scroll_to_interaction(
+                    WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container),
+                    interactionId);
+            }
         });
 
     if (!priv->conversation_) return;
@@ -1287,7 +1567,7 @@ on_main_action_clicked(ChatView *self)
             }
             gtk_widget_destroy(priv->record_popover);
             priv->cpp->current_action_ = RecordAction::RECORD;
-            priv->cpp->avModel_->stopPreview("camera://" + priv->cpp->avModel_->getDefaultDevice());
+            camera_preview_release(&priv->camera_preview);
             QObject::disconnect(priv->local_renderer_connection);
             break;
         }
@@ -1360,6 +1640,46 @@ init_video_widget(ChatView* self)
     clutter_actor_set_y_align(actor_controls, CLUTTER_ACTOR_ALIGN_END);
 }
 
+static void
+on_search_changed(GtkSearchEntry* entry, ChatView* self)
+{
+    g_return_if_fail(IS_CHAT_VIEW(self));
+    auto* priv = CHAT_VIEW_GET_PRIVATE(self);
+    priv->cpp->search(gtk_entry_get_text(GTK_ENTRY(entry)));
+}
+
+static void
+on_search_next(ChatView* self)
+{
+    g_return_if_fail(IS_CHAT_VIEW(self));
+    auto* priv = CHAT_VIEW_GET_PRIVATE(self);
+    // results are sorted from the most recent, next goes up the history
+    priv->cpp->showSearchResult(priv->cpp->searchPos_ + 1);
+}
+
+static void
+on_search_previous(ChatView* self)
+{
+    g_return_if_fail(IS_CHAT_VIEW(self));
+    auto* priv = CHAT_VIEW_GET_PRIVATE(self);
+    if (priv->cpp->searchPos_ > 0)
+        priv->cpp->showSearchResult(priv->cpp->searchPos_ - 1);
+}
+
+static gboolean
+on_key_pressed(GtkWidget*, GdkEventKey* event, ChatView* self)
+{
+    g_return_val_if_fail(IS_CHAT_VIEW(self), FALSE);
+    auto* priv = CHAT_VIEW_GET_PRIVATE(self);
+
+    if ((event->state & GDK_CONTROL_MASK) && event->keyval == GDK_KEY_f) {
+        gtk_search_bar_set_search_mode(GTK_SEARCH_BAR(priv->search_bar), TRUE);
+        gtk_widget_grab_focus(priv->search_entry);
+        return TRUE;
+    }
+    return FALSE;
+}
+
 static void
 build_chat_view(ChatView* self)
 {
@@ -1410,17 +1730,27 @@ build_chat_view(ChatView* self)
 
     priv->composing_changed_connection = QObject::connect(
     &*(*priv->accountInfo_)->conversationModel, &lrc::api::ConversationModel::composingStatusChanged,
-    [self, priv](const QString& uid, const QString& contactUri, bool isComposing) {
-        if (!g_settings_get_boolean(priv->settings, "enable-typing-indication")) return;
-        if (!priv->conversation_) return;
-        if (uid == priv->conversation_->uid) {
-            webkit_chat_set_is_composing(
-                WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container),
-                contactUri.toStdString(), isComposing);
-        }
+    [priv](const QString& uid, const QString& contactUri, bool isComposing) {
+        if (!priv->conversation_ || !priv->cpp) return;
+        if (uid == priv->conversation_->uid)
+            priv->cpp->peerComposing(contactUri.toStdString(), isComposing);
     });
 
     priv->cpp = new CppImpl(*self);
+    priv->cpp->typingIndication_ = g_settings_get_boolean(priv->settings, "enable-typing-indication");
+    priv->cpp->typingIndicationChanged_ = g_signal_connect(priv->settings,
+                                                           "changed::enable-typing-indication",
+                                                           G_CALLBACK(on_typing_indication_changed),
+                                                           self);
+
+    gtk_search_bar_connect_entry(GTK_SEARCH_BAR(priv->search_bar), GTK_ENTRY(priv->search_entry));
+    g_signal_connect(priv->search_entry, "search-changed", G_CALLBACK(on_search_changed), self);
+    g_signal_connect_swapped(priv->search_entry, "activate", G_CALLBACK(on_search_next), self);
+    g_signal_connect_swapped(priv->search_entry, "next-match", G_CALLBACK(on_search_next), self);
+    g_signal_connect_swapped(priv->search_entry, "previous-match", G_CALLBACK(on_search_previous), self);
+    g_signal_connect_swapped(priv->button_search_next, "clicked", G_CALLBACK(on_search_next), self);
+    g_signal_connect_swapped(priv->button_search_previous, "clicked", G_CALLBACK(on_search_previous), self);
+    g_signal_connect(self, "key-press-event", G_CALLBACK(on_key_pressed), self);
 
     if (webkit_chat_container_is_ready(WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container)))
         webkit_chat_container_ready(self);
@@ -1491,3 +1821,19 @@ chat_view_set_plugin_visible(ChatView *self, gboolean visible)
     auto priv = CHAT_VIEW_GET_PRIVATE(self);
     webkit_chat_set_plugin_visible(WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container), visible);
 }
+
+void
+chat_view_show_interaction(ChatView *self, const std::string& interactionId)
+{
+    g_return_if_fail(IS_CHAT_VIEW(self));
+    auto priv = CHAT_VIEW_GET_PRIVATE(self);
+    if (!priv->ready_) {
+        // jump once the history is displayed
+        priv->cpp->pendingJump_ = interactionId;
+        return;
+    }
+    priv->cpp->recenteredJump_.clear();
+    webkit_chat_container_scroll_to_interaction(
+        WEBKIT_CHAT_CONTAINER(priv->webkit_chat_container),
+        interactionId);
+}
@@ -65,5 +65,6 @@ void chat_view_update_temporary(ChatView*);
 void chat_view_set_header_visible(ChatView*, gboolean);
 void chat_view_set_record_visible(ChatView*, gboolean);
 void chat_view_set_plugin_visible(ChatView*, gboolean);
+void chat_view_show_interaction(ChatView*, const std::string& interactionId);
 
 G_END_DECLS
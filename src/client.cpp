@@ -49,6 +49,8 @@
 #include "config.h"
 #include "utils/drawing.h"
 #include "utils/files.h"
+#include "utils/calltelemetry.h"
+#include "utils/startuptracer.h"
 
 #if HAVE_AYATANAAPPINDICATOR
 #include <libayatana-appindicator/app-indicator.h>
@@ -262,7 +264,7 @@ toggle_smartinfo(GSimpleAction *action, GVariant *parameter, gpointer)
     g_simple_action_set_state(action, parameter);
     if (g_variant_get_boolean(parameter)) {
         SmartInfoHub::instance().start();
-    } else {
+    } else if (!call_telemetry_uses_smart_info()) {
         SmartInfoHub::instance().stop();
     }
 }
@@ -493,7 +495,9 @@ client_activate(GApplication *app)
 
     if (priv->win == NULL) {
         // activate being called for the first time
+        startup_tracer_begin("main_window_new");
         priv->win = main_window_new(GTK_APPLICATION(app));
+        startup_tracer_end("main_window_new");
 
         /* make sure win is set to NULL when the window is destroyed */
         g_object_add_weak_pointer(G_OBJECT(priv->win), (gpointer *)&priv->win);
@@ -533,6 +537,7 @@ client_startup(GApplication *app)
     ClientPrivate *priv = CLIENT_GET_PRIVATE(client);
 
     g_message("Jami GNOME client version: %s", VERSION);
+    startup_tracer_begin("client_startup");
 
     /* make sure that the system corresponds to the autostart setting */
     autostart_symlink(g_settings_get_boolean(priv->settings, "start-on-login"));
@@ -540,12 +545,15 @@ client_startup(GApplication *app)
 
     /* init clutter */
     int clutter_error;
+    startup_tracer_begin("gtk_clutter_init");
     if ((clutter_error = gtk_clutter_init(&priv->argc, &priv->argv)) != CLUTTER_INIT_SUCCESS) {
         g_error("Could not init clutter : %d\n", clutter_error);
         exit(1); /* the g_error above should normally cause the application to exit */
     }
+    startup_tracer_end("gtk_clutter_init");
 
     /* init libRingClient and make sure its connected to the dbus */
+    startup_tracer_begin("QCoreApplication");
     try {
         priv->qtapp = new QCoreApplication(priv->argc, priv->argv);
         /* the call model will try to connect to jamid via dbus */
@@ -556,8 +564,10 @@ client_startup(GApplication *app)
         exception_dialog(msg.toLocal8Bit().constData());
         exit(1);
     }
+    startup_tracer_end("QCoreApplication");
 
     /* load translations from LRC */
+    startup_tracer_begin("LRC translations");
     const auto locale_name = QLocale::system().name();
     const auto locale_lang = locale_name.split('_')[0];
 
@@ -582,6 +592,8 @@ client_startup(GApplication *app)
         );
     }
 
+    startup_tracer_end("LRC translations");
+
     /* init delegates */
     GlobalInstances::setDBusErrorHandler(std::unique_ptr<Interfaces::DBusErrorHandler>(new Interfaces::DBusErrorHandler()));
 
@@ -609,6 +621,7 @@ client_startup(GApplication *app)
     accelerators(CLIENT(app));
 
     G_APPLICATION_CLASS(client_parent_class)->startup(app);
+    startup_tracer_end("client_startup");
 }
 
 static void
@@ -633,6 +646,8 @@ client_shutdown(GApplication *app)
 
     g_clear_object(&priv->settings);
 
+    startup_tracer_write();
+
     /* Chain up to the parent class */
     G_APPLICATION_CLASS(client_parent_class)->shutdown(app);
 }
@@ -22,6 +22,8 @@
 
 #include "config.h"
 #include "client.h"
+#include "utils/calltelemetry.h"
+#include "utils/startuptracer.h"
 #include <glib/gi18n.h>
 #include <gtk/gtk.h>
 #include <stdlib.h>
@@ -48,6 +50,25 @@ option_debug_cb(G_GNUC_UNUSED const gchar *option_name,
     return TRUE;
 }
 
+static gboolean
+option_trace_startup_cb(G_GNUC_UNUSED const gchar *option_name,
+                        const gchar *value,
+                        G_GNUC_UNUSED gpointer data,
+                        G_GNUC_UNUSED GError **error)
+{
+    startup_tracer_enable(value);
+    return TRUE;
+}
+
+G_GNUC_NORETURN static gboolean
+option_call_summary_cb(G_GNUC_UNUSED const gchar *option_name,
+                       const gchar *value,
+                       G_GNUC_UNUSED gpointer data,
+                       G_GNUC_UNUSED GError **error)
+{
+    exit(call_telemetry_print_summary(value) ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
 static gboolean
 option_restore_cb(G_GNUC_UNUSED const gchar *option_name,
                   G_GNUC_UNUSED const gchar *value,
@@ -63,6 +84,10 @@ option_restore_cb(G_GNUC_UNUSED const gchar *option_name,
 static const GOptionEntry all_options[] = {
     {"version", 'v', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, option_version_cb, NULL, NULL},
     {"debug", 'd', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, option_debug_cb, N_("Enable debug"), NULL},
+    {"trace-startup", 0, G_OPTION_FLAG_OPTIONAL_ARG, G_OPTION_ARG_CALLBACK, option_trace_startup_cb,
+     N_("Record the duration of the startup phases, written to FILE in the Chrome trace format once startup is over, or after a minute at most"), N_("FILE")},
+    {"call-summary", 0, G_OPTION_FLAG_OPTIONAL_ARG, G_OPTION_ARG_CALLBACK, option_call_summary_cb,
+     N_("Print the timeline recorded for a call, the last one if FILE is not given, and exit"), N_("FILE")},
     {"restore-last-window-state", 'r', G_OPTION_FLAG_NO_ARG, G_OPTION_ARG_CALLBACK, option_restore_cb,
      N_("Restores the hidden state of the main window (only applicable to the primary instance)"), NULL},
     {NULL} /* list must be NULL-terminated */
@@ -25,9 +25,11 @@
 #include <chrono>
 #include <iomanip> // for std::put_time
 #include <string>
+#include <utility>
 #include <sstream>
 
 // GTK+ related
+#include <glib/gi18n.h>
 #include <QSize>
 
 // LRC
@@ -39,8 +41,10 @@
 
 // Gnome client
 #include "conversationpopupmenu.h"
+#include "marshals.h"
 #include "utils/drawing.h"
 #include "utils/files.h"
+#include "utils/startuptracer.h"
 
 static constexpr const char* CALL_TARGET    = "CALL_TARGET";
 static constexpr int         CALL_TARGET_ID = 0;
@@ -72,6 +76,10 @@ struct _ConversationsViewPrivate
     bool useDarkTheme {false};
     details::CppImpl* cpp {nullptr};
 
+    /* not displayed, the model is rebuilt at most once per BACKGROUND_REFRESH_MS */
+    bool active {true};
+    guint refreshSource {0};
+
     QMetaObject::Connection selection_updated;
     QMetaObject::Connection layout_changed;
     QMetaObject::Connection modelSortedConnection_;
@@ -114,6 +122,10 @@ public:
     explicit CppImpl();
 
     QString status;
+
+    // global message search, shown after the conversations
+    std::string messageQuery;
+    std::vector<MessageIndexStore::Hit> messageResults;
 };
 
 CppImpl::CppImpl()
@@ -122,6 +134,15 @@ CppImpl::CppImpl()
 
 }}
 
+static constexpr guint BACKGROUND_REFRESH_MS = 2000;
+
+enum {
+    MESSAGE_RESULT_SELECTED,
+    LAST_SIGNAL
+};
+
+static guint conversations_view_signals[LAST_SIGNAL] = { 0 };
+
 static void
 render_contact_photo(G_GNUC_UNUSED GtkTreeViewColumn *tree_column,
                      GtkCellRenderer *cell,
@@ -276,15 +297,33 @@ render_time(G_GNUC_UNUSED GtkTreeViewColumn *tree_column,
     auto row = std::atoi(gtk_tree_path_to_string(path));
     g_return_if_fail(row != -1);
     gchar *uid;
+    gchar *interactionId;
+    gint64 interactionTimestamp;
 
     gtk_tree_model_get (model, iter,
                         0 /* col# */, &uid /* data */,
+                        6 /* col# */, &interactionId /* data */,
+                        7 /* col# */, &interactionTimestamp /* data */,
                         -1);
     if (g_strcmp0(uid, "") == 0) {
         g_object_set(G_OBJECT(cell), "markup", "", NULL);
         g_free(uid);
+        g_free(interactionId);
+        return;
+    }
+    if (interactionId && *interactionId) {
+        // message search result
+        std::time_t timestamp = interactionTimestamp;
+        std::stringstream date;
+        date << std::put_time(std::localtime(&timestamp), "%x");
+        gchar* text = g_markup_printf_escaped("<span size=\"smaller\" color=\"#666\">%s</span>", date.str().c_str());
+        g_object_set(G_OBJECT(cell), "markup", text, NULL);
+        g_free(text);
+        g_free(uid);
+        g_free(interactionId);
         return;
     }
+    g_free(interactionId);
 
     try
     {
@@ -401,11 +440,73 @@ load_conversations(gpointer data)
     }
 }
 
+static void
+append_message_results(ConversationsView *self, GtkListStore *store)
+{
+    auto priv = CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    if (!priv->cpp || priv->cpp->messageResults.empty() || !*priv->accountInfo_)
+        return;
+    auto& conversationModel = (*priv->accountInfo_)->conversationModel;
+
+    GtkTreeIter iter;
+    gtk_list_store_append(store, &iter);
+    gtk_list_store_set(store, &iter,
+                       0 /* col # */ , "" /* celldata */,
+                       1 /* col # */ , _("Messages") /* celldata */,
+                       2 /* col # */ , "" /* celldata */,
+                       3 /* col # */ , "" /* celldata */,
+                       4 /* col # */ , "" /* celldata */,
+                       5 /* col # */ , "" /* celldata */,
+                       -1 /* end */);
+
+    for (const auto& hit : priv->cpp->messageResults) {
+        auto convUid = QString::fromStdString(hit.conversation);
+        auto convOpt = conversationModel->getConversationForUid(convUid);
+        auto contacts = conversationModel->peersForConversation(convUid);
+        if (!convOpt || contacts.empty())
+            continue;
+        try {
+            auto contactInfo = (*priv->accountInfo_)->contactModel->getContact(contacts.front());
+            // swarm history is loaded on demand, the message may not be there yet
+            QString body;
+            auto& interactions = convOpt->get().interactions;
+            auto it = interactions->find(QString::fromStdString(hit.interactionId));
+            if (it != interactions->end())
+                body = it->second.body;
+            else
+                body = QString::fromStdString(priv->cpp->messageQuery);
+            body.replace('\n', ' ');
+            auto alias = conversationModel->title(convUid);
+            alias.remove('\r');
+            gtk_list_store_append(store, &iter);
+            gtk_list_store_set(store, &iter,
+                               0 /* col # */ , hit.conversation.c_str() /* celldata */,
+                               1 /* col # */ , qUtf8Printable(alias) /* celldata */,
+                               2 /* col # */ , qUtf8Printable(contactInfo.profileInfo.uri) /* celldata */,
+                               3 /* col # */ , qUtf8Printable(contactInfo.registeredName) /* celldata */,
+                               4 /* col # */ , qUtf8Printable(contactInfo.profileInfo.avatar) /* celldata */,
+                               5 /* col # */ , qUtf8Printable(body) /* celldata */,
+                               6 /* col # */ , hit.interactionId.c_str() /* celldata */,
+                               7 /* col # */ , (gint64) hit.timestamp /* celldata */,
+                               -1 /* end */);
+        } catch (const std::out_of_range&) {
+            // ContactModel::getContact() exception
+        }
+    }
+}
+
 static void
 cleanup_load_conversations(gpointer data)
 {
     struct idle_data *d = (struct idle_data *) data;
     g_assert(d->state == STATE_COMPLETE);
+    // message results go after the conversations, wait for every loader
+    auto loaders = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(d->list_store), "loaders")) - 1;
+    g_object_set_data(G_OBJECT(d->list_store), "loaders", GINT_TO_POINTER(loaders));
+    if (loaders == 0) {
+        append_message_results(CONVERSATIONS_VIEW(d->tree_view), d->list_store);
+        startup_tracer_mark("conversations loaded");
+    }
     gtk_tree_view_set_model(GTK_TREE_VIEW(d->tree_view),
                             GTK_TREE_MODEL(d->list_store));
     g_free(d);
@@ -425,6 +526,8 @@ lazy_load_conversations(AccountInfoPointer const *accountInfo,
     data->tree_view = tree_view;
     data->accountInfo = accountInfo;
     data->items = items;
+    auto loaders = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(list_store), "loaders")) + 1;
+    g_object_set_data(G_OBJECT(list_store), "loaders", GINT_TO_POINTER(loaders));
     data->id = g_idle_add_full(G_PRIORITY_HIGH_IDLE,
                                load_conversations,
                                data,
@@ -445,9 +548,18 @@ update_conversation(ConversationsView *self, const std::string& uid) {
         if (!iterIsCorrect)
             break;
         gchar *uidModel;
+        gchar *interactionId;
         gtk_tree_model_get (model, &iter,
                             0 /* col# */, &uidModel /* data */,
+                            6 /* col# */, &interactionId /* data */,
                             -1);
+        // message results follow the conversations, they are not updated
+        auto isMessageResult = interactionId && *interactionId;
+        g_free(interactionId);
+        if (isMessageResult) {
+            g_free(uidModel);
+            return;
+        }
         if(std::string(uid) == uidModel) {
             // Get informations
             auto convOpt = (*priv->accountInfo_)->conversationModel->getConversationForUid(uidModel);
@@ -486,16 +598,18 @@ static void
 create_and_fill_model(ConversationsView *self)
 {
     auto priv = CONVERSATIONS_VIEW_GET_PRIVATE(self);
-    auto store = gtk_list_store_new(6 /* # of cols */ ,
+    auto store = gtk_list_store_new(8 /* # of cols */ ,
                                     G_TYPE_STRING,
                                     G_TYPE_STRING,
                                     G_TYPE_STRING,
                                     G_TYPE_STRING,
                                     G_TYPE_STRING,
                                     G_TYPE_STRING,
-                                    G_TYPE_UINT);
+                                    G_TYPE_STRING, /* interaction id of a message result */
+                                    G_TYPE_INT64); /* timestamp of a message result */
     if (!priv) return;
 
+    startup_tracer_begin("create_and_fill_model");
     GtkTreeIter iter;
 
     if (priv->cpp && !priv->cpp->status.isEmpty()) {
@@ -531,6 +645,13 @@ create_and_fill_model(ConversationsView *self)
                                 (GtkWidget *) self,
                                 store, list);
     }
+
+    if (!g_object_get_data(G_OBJECT(store), "loaders")) {
+        // nothing to load, the conversations list is empty
+        append_message_results(self, store);
+        gtk_tree_view_set_model(GTK_TREE_VIEW(self), GTK_TREE_MODEL(store));
+    }
+    startup_tracer_end("create_and_fill_model");
 }
 
 static void
@@ -586,10 +707,17 @@ select_conversation(GtkTreeSelection *selection, ConversationsView *self)
 
     if (!gtk_tree_selection_get_selected(selection, &model, &iter)) return;
 
+    gchar *interactionId = nullptr;
     gtk_tree_model_get(model, &iter,
                        0, &conversationUid,
+                       6, &interactionId,
                        -1);
     (*priv->accountInfo_)->conversationModel->selectConversation(QString(conversationUid));
+    if (interactionId && *interactionId)
+        g_signal_emit(G_OBJECT(self), conversations_view_signals[MESSAGE_RESULT_SELECTED], 0,
+                      conversationUid, interactionId);
+    g_free(conversationUid);
+    g_free(interactionId);
 }
 
 static void
@@ -762,6 +890,34 @@ on_drag_data_received(GtkWidget        *treeview,
     gtk_drag_finish(context, success, FALSE, time);
 }
 
+static gboolean
+refresh_in_background(ConversationsView *self)
+{
+    auto* priv = CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    priv->refreshSource = 0;
+    create_and_fill_model(self);
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * Rebuild the model now if the view is displayed, else coalesce the changes
+ * so that a view kept for a background account stays cheap and up to date.
+ */
+static void
+request_refresh(ConversationsView *self)
+{
+    auto* priv = CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    if (priv->active) {
+        create_and_fill_model(self);
+    } else if (!priv->refreshSource) {
+        priv->refreshSource = g_timeout_add_full(G_PRIORITY_LOW,
+                                                 BACKGROUND_REFRESH_MS,
+                                                 (GSourceFunc)refresh_in_background,
+                                                 self,
+                                                 nullptr);
+    }
+}
+
 static void
 build_conversations_view(ConversationsView *self)
 {
@@ -819,7 +975,7 @@ build_conversations_view(ConversationsView *self)
     &*(*priv->accountInfo_)->conversationModel,
     &lrc::api::ConversationModel::modelChanged,
     [self] () {
-        create_and_fill_model(self);
+        request_refresh(self);
     });
 
 
@@ -827,7 +983,7 @@ build_conversations_view(ConversationsView *self)
     &*(*priv->accountInfo_)->conversationModel,
     &lrc::api::ConversationModel::searchResultUpdated,
     [self] () {
-        create_and_fill_model(self);
+        request_refresh(self);
     });
     priv->searchStatusChangedConnection_ = QObject::connect(
     &*(*priv->accountInfo_)->conversationModel,
@@ -883,13 +1039,18 @@ build_conversations_view(ConversationsView *self)
     &*(*priv->accountInfo_)->conversationModel,
     &lrc::api::ConversationModel::filterChanged,
     [self] () {
-        create_and_fill_model(self);
+        request_refresh(self);
     });
 
     priv->callChangedConnection_ = QObject::connect(
     &*(*priv->accountInfo_)->callModel,
     &lrc::api::NewCallModel::callStatusChanged,
     [self, priv] (const QString&) {
+        if (!priv->active) {
+            request_refresh(self);
+            return;
+        }
+
         // retrieve currently selected conversation
         GtkTreeIter iter;
         GtkTreeModel *model = nullptr;
@@ -959,6 +1120,11 @@ conversations_view_dispose(GObject *object)
     QObject::disconnect(priv->filterChangedConnection_);
     QObject::disconnect(priv->callChangedConnection_);
 
+    if (priv->refreshSource) {
+        g_source_remove(priv->refreshSource);
+        priv->refreshSource = 0;
+    }
+
     gtk_widget_destroy(priv->popupMenu_);
     delete priv->cpp;
     priv->cpp = nullptr;
@@ -977,6 +1143,16 @@ conversations_view_class_init(ConversationsViewClass *klass)
 {
     G_OBJECT_CLASS(klass)->finalize = conversations_view_finalize;
     G_OBJECT_CLASS(klass)->dispose = conversations_view_dispose;
+
+    conversations_view_signals[MESSAGE_RESULT_SELECTED] = g_signal_new(
+        "message-result-selected",
+        G_TYPE_FROM_CLASS(klass),
+        (GSignalFlags) (G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION),
+        0,
+        nullptr,
+        nullptr,
+        g_cclosure_user_marshal_VOID__STRING_STRING,
+        G_TYPE_NONE, 2, G_TYPE_STRING, G_TYPE_STRING);
 }
 
 GtkWidget *
@@ -1059,3 +1235,65 @@ conversations_view_set_theme(ConversationsView *self, bool darkTheme) {
     priv->useDarkTheme = darkTheme;
 }
 
+void
+conversations_view_set_active(ConversationsView *self, bool active)
+{
+    g_return_if_fail(IS_CONVERSATIONS_VIEW(self));
+    auto priv = CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    priv->active = active;
+    if (active && priv->refreshSource) {
+        // apply the changes received in background
+        g_source_remove(priv->refreshSource);
+        priv->refreshSource = 0;
+        create_and_fill_model(self);
+    }
+}
+
+void
+conversations_view_set_message_results(ConversationsView *self,
+                                       const std::string& query,
+                                       std::vector<MessageIndexStore::Hit> results)
+{
+    g_return_if_fail(IS_CONVERSATIONS_VIEW(self));
+    auto priv = CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    if (!priv->cpp)
+        return;
+    auto changed = !(results.empty() && priv->cpp->messageResults.empty());
+    priv->cpp->messageQuery = query;
+    priv->cpp->messageResults = std::move(results);
+    if (!changed)
+        return;
+
+    auto model = gtk_tree_view_get_model(GTK_TREE_VIEW(self));
+    // a model still being loaded appends the results once complete
+    if (!model || g_object_get_data(G_OBJECT(model), "loaders"))
+        return;
+
+    // only replace the "Messages" section, at the end of the list
+    auto store = GTK_LIST_STORE(model);
+    GtkTreeIter iter;
+    auto rows = gtk_tree_model_iter_n_children(model, nullptr);
+    while (rows > 0 && gtk_tree_model_iter_nth_child(model, &iter, nullptr, rows - 1)) {
+        gchar *uidModel;
+        gchar *title;
+        gchar *interactionId;
+        gtk_tree_model_get(model, &iter,
+                           0 /* col# */, &uidModel /* data */,
+                           1 /* col# */, &title /* data */,
+                           6 /* col# */, &interactionId /* data */,
+                           -1);
+        auto isMessageResult = interactionId && *interactionId;
+        auto isHeader = !isMessageResult && uidModel && !*uidModel
+                        && g_strcmp0(title, _("Messages")) == 0;
+        g_free(uidModel);
+        g_free(title);
+        g_free(interactionId);
+        if (!isMessageResult && !isHeader)
+            break;
+        gtk_list_store_remove(store, &iter);
+        --rows;
+        if (isHeader)
+            break;
+    }
+    append_message_results(self, store);
+}
@@ -20,9 +20,12 @@
 
 #include <gtk/gtk.h>
 
+#include <vector>
+
 #include "api/account.h"
 
 #include "accountinfopointer.h"
+#include "utils/messageindex.h"
 
 G_BEGIN_DECLS
 
@@ -40,5 +43,12 @@ GtkWidget  *conversations_view_new                 (AccountInfoPointer const & a
 void        conversations_view_select_conversation (ConversationsView *self, const std::string& uid);
 std::string conversations_view_get_current_selected(ConversationsView *self);
 void        conversations_view_set_theme(ConversationsView *self, bool darkTheme);
+/**
+ * An inactive view is not displayed, it coalesces the model updates.
+ */
+void        conversations_view_set_active(ConversationsView *self, bool active);
+void        conversations_view_set_message_results(ConversationsView *self,
+                                                   const std::string& query,
+                                                   std::vector<MessageIndexStore::Hit> results);
 
 G_END_DECLS
@@ -22,8 +22,11 @@
  // Client
 #include "chatview.h"
 #include "notifier.h"
+#include "utils/avatarcache.h"
 #include "utils/drawing.h"
 #include "utils/files.h"
+#include "utils/styleregistry.h"
+#include "video/smartinfopanel.h"
 #include "video/video_widget.h"
 
 // Lrc
@@ -45,7 +48,10 @@
 #include <QSize>
 #include <QJsonObject>
 
+#include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 
 #define PLUGIN_ICON_SIZE 25
 
@@ -137,6 +143,7 @@ namespace { namespace details
 
 static constexpr int CONTROLS_FADE_TIMEOUT = 3000000; /* microseconds */
 static constexpr int FADE_DURATION = 500; /* miliseconds */
+static constexpr int QUALITY_UPDATE_DELAY = 250; /* miliseconds */
 static guint current_call_view_signals[LAST_SIGNAL] = { 0 };
 
 namespace // Helpers
@@ -223,8 +230,53 @@ gtk_scale_button_get_scale(GtkScaleButton* button)
     return scale;
 }
 
+static std::string
+lowercase(const gchar* text)
+{
+    auto* lower = g_utf8_strdown(text, -1);
+    std::string result = lower;
+    g_free(lower);
+    return result;
+}
+
+static std::set<std::string>
+trigrams(const std::string& text)
+{
+    std::set<std::string> result;
+    for (std::size_t i = 0; i + 3 <= text.size(); ++i)
+        result.emplace(text.substr(i, 3));
+    return result;
+}
+
+static std::string
+invite_key(RowType type, const QString& data)
+{
+    return std::to_string(static_cast<int>(type)) + ':' + data.toStdString();
+}
+
+/**
+ * Position of a row of the invite list: the conferences come first, then the
+ * calls and the contacts, each section under its title (order 0).
+ */
+static guint
+invite_rank(RowType section, guint order)
+{
+    guint position = section == RowType::CONFERENCE ? 0 : section == RowType::CALL ? 1 : 2;
+    return position << 24 | order;
+}
+
 } // namespace
 
+struct InviteCandidate
+{
+    RowType type;
+    QString data; // the conference, call or contact to invite
+    std::string peer; // empty for the conferences
+    std::string search; // lowercase text of the row
+    GtkWidget* row;
+    QString account; // of the peer, empty for the conferences
+};
+
 class CppImpl
 {
 public:
@@ -238,11 +290,25 @@ public:
                lrc::api::AVModel& avModel);
 
     void updateConvList();
+    void invalidateCallCandidates();
+    void invalidateContactCandidates();
+    void updateCallCandidates();
+    void updateContactCandidates();
+    bool updateContactCandidate(const QString& uri);
+    void addInviteCandidate(const std::string& key, InviteCandidate&& candidate);
+    void removeInviteCandidate(const std::string& key);
+    void placeInviteCandidate(const std::string& key, guint order);
+    void refreshPeerCandidates(const QString& uri);
+    bool isInviteCandidateShown(const std::string& key, const InviteCandidate& candidate) const;
+    void matchInviteCandidate(const std::string& key, const InviteCandidate& candidate);
+    void unmatchInviteCandidate(const std::string& key);
+    void filterInviteCandidates();
+    void filterInviteCandidate(const std::string& key, RowType section);
     void updatePluginList();
     void add_transfer_contact(const std::string& uri);
-    void add_title(const QString& title);
-    void add_present_contact(const QString& uri, const QString& custom_data, RowType custom_type, const QString& accountId);
-    void add_conference(const VectorString& uris, const QString& custom_data, const QString& accountId);
+    GtkWidget* add_title(const QString& title, RowType section);
+    GtkWidget* add_present_contact(const QString& uri, const QString& accountId);
+    GtkWidget* add_conference(const VectorString& uris, const QString& accountId);
     void add_media_handler(lrc::api::plugin::PluginHandlerDetails mediaHandlerDetails);
 
     void insertControls();
@@ -265,6 +331,8 @@ public:
     QMetaObject::Connection renderer_connection;
     QMetaObject::Connection smartinfo_refresh_connection;
     QMetaObject::Connection remoteinfo_connection;
+    QMetaObject::Connection presence_connection;
+    QMetaObject::Connection contacts_connection;
 
     // for clutter animations and to know when to fade in/out the overlays
     ClutterTransition* fade_info = nullptr;
@@ -277,13 +345,34 @@ public:
      * we do not want to update the codec bitrate until the user releases the
      * scale button */
     gboolean quality_scale_pressed = FALSE;
+    // pending update of the steps of the quality scale
+    guint quality_timer = 0;
     gulong insert_controls_id = 0;
     guint smartinfo_action = 0;
+    // -1 until the description of the SmartInfo is set
+    int smartinfo_conference = -1;
 
     const lrc::api::Lrc& lrc_;
 
-    std::vector<std::string> titles_;
-    std::set<std::string> hiddenTitles_;
+    // candidates of the invite list by key, their rows kept across the
+    // updates. They are filtered through the trigrams of their text.
+    std::unordered_map<std::string, InviteCandidate> inviteCandidates_;
+    std::unordered_map<std::string, std::unordered_set<std::string>> inviteTrigrams_;
+    std::unordered_set<std::string> inviteMatches_;
+    std::string inviteFilter_;
+    bool inviteFiltered_ = false;
+    // the matches counted in sectionMatches_, with their section
+    std::unordered_map<std::string, RowType> shownMatches_;
+    std::map<RowType, GtkWidget*> sectionTitles_;
+    // the calls and contacts changed while the invite list was closed, they
+    // are diffed when it opens
+    bool callsDirty_ = true;
+    bool contactsDirty_ = true;
+    // the peers already in a call, not proposed as contacts
+    std::unordered_set<std::string> busyUris_;
+    std::map<RowType, int> sectionMatches_;
+    std::set<RowType> collapsedSections_;
+    guint contactsOrder_ = 0;
 
     std::string currentCall_ {};
 
@@ -306,36 +395,55 @@ static void
 set_call_quality(CurrentCallView* view, bool auto_quality_on, double desired_quality)
 {
     auto* priv = CURRENT_CALL_VIEW_GET_PRIVATE(view);
+    auto& codecModel = (*priv->cpp->accountInfo)->codecModel;
+
+    // Each setter of the codec model is a call to the daemon, so only the
+    // values which differ from the current settings of a codec are sent
+    for (const auto& codec : codecModel->getVideoCodecs()) {
+        if (codec.auto_quality_enabled != auto_quality_on)
+            codecModel->autoQuality(codec.id, auto_quality_on);
+        if (auto_quality_on)
+            continue;
 
-    auto videoCodecs = (*priv->cpp->accountInfo)->codecModel->getVideoCodecs();
-    for (const auto& codec : videoCodecs) {
-        if (auto_quality_on) {
-            (*priv->cpp->accountInfo)->codecModel->autoQuality(codec.id, true);
-        } else {
-            (*priv->cpp->accountInfo)->codecModel->autoQuality(codec.id, false);
-            double min_bitrate = 0., max_bitrate = 0., min_quality = 0., max_quality = 0.;
-            try {
-                min_bitrate = codec.min_bitrate.toInt();
-                max_bitrate = codec.max_bitrate.toInt();
-                min_quality = codec.min_quality.toInt();
-                max_quality = codec.max_quality.toInt();
-            } catch (...) {
-                g_error("Cannot convert a codec value to an int, abort");
-                break;
-            }
-
-            double bitrate = min_bitrate + (max_bitrate - min_bitrate)*(desired_quality/100.0);
-            if (bitrate < 0) bitrate = 0;
-            (*priv->cpp->accountInfo)->codecModel->bitrate(codec.id, bitrate);
-
-            // note: a lower value means higher quality
-            double quality = min_quality - (min_quality - max_quality)*(desired_quality/100.0);
-            if (quality < 0) quality = 0;
-            (*priv->cpp->accountInfo)->codecModel->quality(codec.id, quality);
+        double min_bitrate = 0., max_bitrate = 0., min_quality = 0., max_quality = 0.;
+        try {
+            min_bitrate = codec.min_bitrate.toInt();
+            max_bitrate = codec.max_bitrate.toInt();
+            min_quality = codec.min_quality.toInt();
+            max_quality = codec.max_quality.toInt();
+        } catch (...) {
+            g_error("Cannot convert a codec value to an int, abort");
+            break;
         }
+
+        double bitrate = min_bitrate + (max_bitrate - min_bitrate)*(desired_quality/100.0);
+        if (bitrate < 0) bitrate = 0;
+        // the codec model keeps the values as QString::number() does
+        if (codec.bitrate != QString::number(bitrate))
+            codecModel->bitrate(codec.id, bitrate);
+
+        // note: a lower value means higher quality
+        double quality = min_quality - (min_quality - max_quality)*(desired_quality/100.0);
+        if (quality < 0) quality = 0;
+        if (codec.quality != QString::number(quality))
+            codecModel->quality(codec.id, quality);
     }
 }
 
+static gboolean
+apply_call_quality(CurrentCallView* view)
+{
+    g_return_val_if_fail(IS_CURRENT_CALL_VIEW(view), G_SOURCE_REMOVE);
+    auto priv = CURRENT_CALL_VIEW_GET_PRIVATE(view);
+
+    priv->cpp->quality_timer = 0;
+    /* no need to update quality if auto quality is enabled */
+    if (!gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(priv->checkbutton_autoquality)))
+        set_call_quality(view, false, gtk_scale_button_get_value(GTK_SCALE_BUTTON(priv->scalebutton_quality)));
+
+    return G_SOURCE_REMOVE;
+}
+
 static void
 set_record_animation(CurrentCallViewPrivate* priv)
 {
@@ -514,6 +622,10 @@ on_autoquality_toggled(GtkToggleButton* button, CurrentCallView* view)
 
     double desired_quality = gtk_scale_button_get_value(GTK_SCALE_BUTTON(priv->scalebutton_quality));
 
+    if (priv->cpp->quality_timer) {
+        g_source_remove(priv->cpp->quality_timer);
+        priv->cpp->quality_timer = 0;
+    }
     set_call_quality(view, auto_quality_on, desired_quality);
 }
 
@@ -530,7 +642,11 @@ on_quality_changed(G_GNUC_UNUSED GtkScaleButton *button, G_GNUC_UNUSED gdouble v
     /* update only if the scale button is released (reduces the number of updates) */
     if (priv->cpp->quality_scale_pressed) return;
 
-    set_call_quality(view, false, gtk_scale_button_get_value(button));
+    /* and at most every QUALITY_UPDATE_DELAY while the keys, the wheel or the
+     * +/- buttons move it, the last step being sent with the timer */
+    if (!priv->cpp->quality_timer)
+        priv->cpp->quality_timer = g_timeout_add(QUALITY_UPDATE_DELAY,
+                                                 (GSourceFunc)apply_call_quality, view);
 }
 
 static gboolean
@@ -554,8 +670,10 @@ on_quality_button_released(G_GNUC_UNUSED GtkWidget *widget, G_GNUC_UNUSED GdkEve
 
     priv->cpp->quality_scale_pressed = FALSE;
 
-    // make sure the quality gets updated
-    on_quality_changed(GTK_SCALE_BUTTON(priv->scalebutton_quality), 0, view);
+    // make sure the quality gets updated, right away
+    if (priv->cpp->quality_timer)
+        g_source_remove(priv->cpp->quality_timer);
+    apply_call_quality(view);
 
     return GDK_EVENT_PROPAGATE;
 }
@@ -694,53 +812,36 @@ transfer_to_conversation(GtkListBox*, GtkListBoxRow* row, CurrentCallView* self)
 }
 
 static void
-on_search_participant(GtkSearchEntry* search_entry, CurrentCallView* self)
+on_search_participant(GtkSearchEntry*, CurrentCallView* self)
 {
     g_return_if_fail(IS_CURRENT_CALL_VIEW(self));
     auto* priv = CURRENT_CALL_VIEW_GET_PRIVATE(self);
+    priv->cpp->filterInviteCandidates();
+}
 
-    std::string search_text = gtk_entry_get_text(GTK_ENTRY(search_entry));
-    std::transform(search_text.begin(), search_text.end(), search_text.begin(), ::tolower);
-
-    auto row = 0, lastTitleRow = -1;
-    auto hideTitle = true;
-    while (GtkWidget* children = GTK_WIDGET(gtk_list_box_get_row_at_index(
-            GTK_LIST_BOX(priv->list_conversations_invite), row))) {
-        auto* addr_label = get_address_label(GTK_LIST_BOX_ROW(children));
-        std::string content = gtk_label_get_text(addr_label);
-        std::transform(content.begin(), content.end(), content.begin(), ::tolower);
-        if (content.find(search_text) == std::string::npos) {
-            bool hide = true;
-            for (auto title: priv->cpp->titles_) {
-                std::transform(title.begin(), title.end(), title.begin(), ::tolower);
-                if (title == content) {
-                    hide = false;
-                    // Hide last title if needed
-                    if (lastTitleRow != -1 && hideTitle) {
-                        auto* lastTitle = GTK_WIDGET(gtk_list_box_get_row_at_index(GTK_LIST_BOX(priv->list_conversations_invite), lastTitleRow));
-                        gtk_widget_hide(lastTitle);
-                    }
-                    lastTitleRow = row;
-                    hideTitle = true;
-                }
-            }
-            if (hide) gtk_widget_hide(children);
-        } else {
-            if (lastTitleRow != -1 && hideTitle) {
-                auto* lastTitle = GTK_WIDGET(gtk_list_box_get_row_at_index(GTK_LIST_BOX(priv->list_conversations_invite), lastTitleRow));
-                gtk_widget_show(lastTitle);
-            }
-            hideTitle = false;
-            gtk_widget_show(children);
-        }
-        row++;
+static gboolean
+filter_invite_row(GtkListBoxRow* row, gpointer user_data)
+{
+    auto* cpp = static_cast<CppImpl*>(user_data);
+    if (auto section = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(row), "invite_section"))) {
+        // the titles of the sections without any candidate are hidden
+        auto it = cpp->sectionMatches_.find(static_cast<RowType>(section - 1));
+        return it != cpp->sectionMatches_.end() && it->second > 0;
     }
+    auto* key = static_cast<const gchar*>(g_object_get_data(G_OBJECT(row), "invite_key"));
+    auto it = cpp->inviteCandidates_.find(key ? key : "");
+    if (it == cpp->inviteCandidates_.end()
+        || cpp->collapsedSections_.find(it->second.type) != cpp->collapsedSections_.end())
+        return FALSE;
+    return cpp->isInviteCandidateShown(it->first, it->second);
+}
 
-    // Hide last title if needed
-    if (lastTitleRow != -1 && hideTitle) {
-        auto* lastTitle = GTK_WIDGET(gtk_list_box_get_row_at_index(GTK_LIST_BOX(priv->list_conversations_invite), lastTitleRow));
-        gtk_widget_hide(lastTitle);
-    }
+static gint
+sort_invite_rows(GtkListBoxRow* row1, GtkListBoxRow* row2, gpointer)
+{
+    auto rank1 = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(row1), "invite_rank"));
+    auto rank2 = GPOINTER_TO_UINT(g_object_get_data(G_OBJECT(row2), "invite_rank"));
+    return rank1 < rank2 ? -1 : rank1 > rank2;
 }
 
 static void
@@ -768,76 +869,45 @@ activate_media_handler(GtkToggleButton* switchBtn, GParamSpec*, CurrentCallView*
 }
 
 static void
-invite_to_conversation(GtkListBox*, GtkListBoxRow* row, CurrentCallView* self)
+invite_to_conversation(GtkListBox* list, GtkListBoxRow* row, CurrentCallView* self)
 {
     auto priv = CURRENT_CALL_VIEW_GET_PRIVATE(self);
 
-    auto* label = get_address_label(GTK_LIST_BOX_ROW(row));
-    std::string content = gtk_label_get_text(label);
-    for (auto title: priv->cpp->titles_) {
-        if (content != title) continue;
-        bool isHiddenTitle = priv->cpp->hiddenTitles_.find(content) != priv->cpp->hiddenTitles_.end();
+    if (auto section = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(row), "invite_section"))) {
+        // A title folds or unfolds its section
+        auto& collapsed = priv->cpp->collapsedSections_;
         auto* image = get_image(row);
-        if (!isHiddenTitle) {
-            priv->cpp->hiddenTitles_.insert(content);
-            gtk_image_set_from_icon_name(image, "pan-up-symbolic", GTK_ICON_SIZE_MENU);
-        } else {
-            priv->cpp->hiddenTitles_.erase(content);
+        if (collapsed.erase(static_cast<RowType>(section - 1))) {
             gtk_image_set_from_icon_name(image, "pan-down-symbolic", GTK_ICON_SIZE_MENU);
+        } else {
+            collapsed.insert(static_cast<RowType>(section - 1));
+            gtk_image_set_from_icon_name(image, "pan-up-symbolic", GTK_ICON_SIZE_MENU);
         }
-        auto changeState = false;
-        auto rowIdx = 0;
-        while (auto* children = gtk_list_box_get_row_at_index(GTK_LIST_BOX(priv->list_conversations_invite), rowIdx)) {
-            rowIdx++;
-            if (children == row) {
-                changeState = true;
-                continue;
-            }
-            if (!changeState) continue;
-            auto* addr_label = get_address_label(GTK_LIST_BOX_ROW(children));
-            std::string content2 = gtk_label_get_text(addr_label);
-            for (auto title: priv->cpp->titles_) {
-                if (content2 == title) return; // Other title, stop here.
-            }
-            if (!isHiddenTitle)
-                gtk_widget_hide(GTK_WIDGET(children));
-            else {
-                gtk_widget_show(GTK_WIDGET(children));
-                // refilter if needed
-                std::string currentFilter = gtk_entry_get_text(GTK_ENTRY(priv->conversation_filter_entry));
-                if (!currentFilter.empty())
-                    on_search_participant(GTK_SEARCH_ENTRY(priv->conversation_filter_entry), self);
-            }
-        }
+        gtk_list_box_invalidate_filter(list);
         return;
     }
 
+    auto* key = static_cast<const gchar*>(g_object_get_data(G_OBJECT(row), "invite_key"));
+    auto it = priv->cpp->inviteCandidates_.find(key ? key : "");
+    if (it == priv->cpp->inviteCandidates_.end())
+        return;
+    const auto& candidate = it->second;
+
     auto callToRender = priv->cpp->conversation->callId;
     if (!priv->cpp->conversation->confId.isEmpty())
         callToRender = priv->cpp->conversation->confId;
 
-    auto rowIdx = 0;
-    while (auto* children = gtk_list_box_get_row_at_index(GTK_LIST_BOX(priv->list_conversations_invite), rowIdx)) {
-        if (children == row) {
-            auto* custom_type = g_object_get_data(G_OBJECT(label), "custom_type");
-            auto custom_data = QString::fromStdString((gchar*)g_object_get_data(G_OBJECT(label), "custom_data"));
-            if (GPOINTER_TO_INT(custom_type) == (int)RowType::CONTACT) {
-                try {
-                    const auto& call = (*priv->cpp->accountInfo)->callModel->getCall(callToRender);
-                    (*priv->cpp->accountInfo)->callModel->callAndAddParticipant(custom_data, callToRender, call.isAudioOnly);
-                } catch (...) {
-                    g_warning("Can't add participant to inexistent call");
-                }
-            } else if (GPOINTER_TO_INT(custom_type)  == (int)RowType::CALL
-                    || GPOINTER_TO_INT(custom_type)  == (int)RowType::CONFERENCE) {
-                (*priv->cpp->accountInfo)->callModel->joinCalls(custom_data, callToRender);
-            }
-            break;
+    if (candidate.type == RowType::CONTACT) {
+        try {
+            const auto& call = (*priv->cpp->accountInfo)->callModel->getCall(callToRender);
+            (*priv->cpp->accountInfo)->callModel->callAndAddParticipant(candidate.data, callToRender, call.isAudioOnly);
+        } catch (...) {
+            g_warning("Can't add participant to inexistent call");
         }
-        ++rowIdx;
+    } else {
+        (*priv->cpp->accountInfo)->callModel->joinCalls(candidate.data, callToRender);
     }
 
-
 #if GTK_CHECK_VERSION(3,22,0)
     gtk_popover_popdown(GTK_POPOVER(priv->add_participant_popover));
 #else
@@ -980,10 +1050,15 @@ CppImpl::~CppImpl()
     QObject::disconnect(renderer_connection);
     QObject::disconnect(smartinfo_refresh_connection);
     QObject::disconnect(remoteinfo_connection);
+    QObject::disconnect(presence_connection);
+    QObject::disconnect(contacts_connection);
+    // the filter of the invite list reads the candidates
+    gtk_list_box_set_filter_func(GTK_LIST_BOX(widgets->list_conversations_invite), nullptr, nullptr, nullptr);
     g_clear_object(&widgets->settings);
 
     if (timer_fade) g_source_remove(timer_fade);
     if (timer_record_fade) g_source_remove(timer_record_fade);
+    if (quality_timer) g_source_remove(quality_timer);
 
     auto* display_smartinfo = g_action_map_lookup_action(G_ACTION_MAP(g_application_get_default()),
                                                         "display-smartinfo");
@@ -994,30 +1069,25 @@ void
 CppImpl::init()
 {
     // CSS styles
-    auto provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider,
-        ".search-entry-style { border: 0; border-radius: 0; } \
-        .smartinfo-block-style { color: #8ae234; background-color: rgba(1, 1, 1, 0.33); } \
-        .remote-recording-block-style { color:rgba(255,255,255,0.7); background-color:rgba(1, 1, 1, 0.3); padding-left: 30px; padding-right: 30px; padding-top: 3px; padding-bottom: 3px; } \
-        @keyframes blink { 0% {opacity: 1;} 49% {opacity: 1;} 50% {opacity: 0;} 100% {opacity: 0;} } \
-        .record-button { background: rgba(0, 0, 0, 1); border-radius: 50%; border: 0; transition: all 0.3s ease; } \
-        .record-button:checked { animation: blink 1s; animation-iteration-count: infinite; } \
-        .call-button { background: rgba(0, 0, 0, 0.35); border-radius: 50%; border: 0; transition: all 0.3s ease; } \
-        .call-button:hover { background: rgba(0, 0, 0, 0.2); } \
-        .call-button:disabled { opacity: 0.2; } \
-        .can-be-disabled:checked { background: rgba(219, 58, 55, 1); } \
-        .hangup-button-style { background: rgba(219, 58, 55, 1); border-radius: 50%; border: 0; transition: all 0.3s ease; } \
-        .hangup-button-style:hover { background: rgba(219, 39, 25, 1); }",
-        -1, nullptr
-    );
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/currentcallview.css");
 
     widgets->video_widget = video_widget_new();
     gtk_container_add(GTK_CONTAINER(widgets->frame_video), widgets->video_widget);
     gtk_widget_show_all(widgets->frame_video);
 
+    // the history of the SmartInfo, sampled only while it's shown
+    gtk_box_pack_start(GTK_BOX(widgets->vbox_call_smartInfo),
+                       smart_info_panel_new(widgets->video_widget),
+                       FALSE, TRUE, 0);
+
+    // the invite list, its rows placed and filtered by the candidates index
+    auto* list = GTK_LIST_BOX(widgets->list_conversations_invite);
+    gtk_list_box_set_sort_func(list, sort_invite_rows, nullptr, nullptr);
+    gtk_list_box_set_filter_func(list, filter_invite_row, this, nullptr);
+    sectionTitles_[RowType::CONFERENCE] = add_title(_("Current conference (all accounts)"), RowType::CONFERENCE);
+    sectionTitles_[RowType::CALL] = add_title(_("Current calls (all accounts)"), RowType::CALL);
+    sectionTitles_[RowType::CONTACT] = add_title(_("Online contacts"), RowType::CONTACT);
+
     // add the overlay controls only once the view has been allocated a size to prevent size
     // allocation warnings in the log
     insert_controls_id = g_signal_connect(self, "size-allocate", G_CALLBACK(on_size_allocate), nullptr);
@@ -1037,7 +1107,6 @@ CppImpl::setup(WebKitChatContainer* chat_widget,
 
     gtk_widget_hide(widgets->togglebutton_transfer);
 
-    updateConvList();
     updatePluginList();
 
     g_signal_connect(widgets->conversation_filter_entry, "search-changed", G_CALLBACK(on_search_participant), self);
@@ -1138,110 +1207,329 @@ CppImpl::updatePluginList()
 void
 CppImpl::updateConvList()
 {
-    auto row = 0;
-    while (GtkWidget* children = GTK_WIDGET(gtk_list_box_get_row_at_index(GTK_LIST_BOX(widgets->list_conversations_invite), row))) {
-        gtk_container_remove(GTK_CONTAINER(widgets->list_conversations_invite), children);
-    }
+    if (!callsDirty_ && !contactsDirty_)
+        return;
+    if (contactsDirty_)
+        updateContactCandidates();
+    if (callsDirty_)
+        updateCallCandidates();
+    callsDirty_ = contactsDirty_ = false;
+    filterInviteCandidates();
+}
 
+void
+CppImpl::invalidateCallCandidates()
+{
+    callsDirty_ = true;
+    if (gtk_widget_get_visible(widgets->add_participant_popover))
+        updateConvList();
+}
+
+void
+CppImpl::invalidateContactCandidates()
+{
+    contactsDirty_ = true;
+    if (gtk_widget_get_visible(widgets->add_participant_popover))
+        updateConvList();
+}
+
+void
+CppImpl::updateCallCandidates()
+{
     auto callToRender = conversation->callId;
     if (!conversation->confId.isEmpty())
         callToRender = conversation->confId;
 
-    VectorString callsId;
-    VectorString uris;
-    bool first = true;
+    std::vector<const lrc::api::account::Info*> accounts;
+    for (const auto &account_id : lrc_.getAccountModel().getAccountList()) {
+        try {
+            accounts.emplace_back(&lrc_.getAccountModel().getAccountInfo(account_id));
+        } catch (...) {}
+    }
+
+    std::unordered_set<std::string> keys;
+    std::unordered_set<std::string> subcalls;
+    busyUris_.clear();
+
+    guint order = 0;
     for (const auto& c : lrc_.getConferences()) {
         // Get participants
-        QString uri, accountId;
+        QString accountId, participants;
         VectorString curis;
-        for (const auto &account_id : lrc_.getAccountModel().getAccountList()) {
+        for (const auto* account : accounts) {
             try {
-                auto &accountInfo = lrc_.getAccountModel().getAccountInfo(account_id);
-                auto cid = accountInfo.callModel->getConferenceSubcalls(c);
-                callsId.append(cid);
+                auto cid = account->callModel->getConferenceSubcalls(c);
+                for (const auto& callId : cid)
+                    subcalls.emplace(callId.toStdString());
                 for (const auto& callId : cid) {
-                    if (accountInfo.callModel->hasCall(callId)) {
-                        const auto& call = accountInfo.callModel->getCall(callId);
-                        uri = QString(call.peerUri).remove("ring:");
-                        uris.push_back(uri);
+                    if (account->callModel->hasCall(callId)) {
+                        const auto& call = account->callModel->getCall(callId);
+                        auto uri = QString(call.peerUri).remove("ring:");
+                        busyUris_.emplace(uri.toStdString());
                         curis.push_back(uri);
-                        accountId = account_id;
+                        participants += '\n' + uri;
+                        accountId = account->id;
                         break;
                     }
                 }
             } catch (...) {}
         }
 
-        if (c == callToRender) {
+        if (c == callToRender || curis.empty())
             continue;
-        }
 
-        if (first) {
-            add_title(_("Current conference (all accounts)"));
-            first = false;
-        }
-        if (!uri.isEmpty()) {
-            add_conference(curis, c, accountId);
-        }
+        // the row shows the participants, it is replaced when they change
+        auto key = invite_key(RowType::CONFERENCE, c + participants);
+        keys.emplace(key);
+        if (inviteCandidates_.find(key) == inviteCandidates_.end())
+            addInviteCandidate(key, {RowType::CONFERENCE, c, {}, {}, add_conference(curis, accountId)});
+        placeInviteCandidate(key, ++order);
     }
 
-    first = true;
+    order = 0;
     for (const auto& c : lrc_.getCalls()) {
         QString uri, accountId;
-        for (const auto &account_id : lrc_.getAccountModel().getAccountList()) {
+        for (const auto* account : accounts) {
             try {
-                auto &accountInfo = lrc_.getAccountModel().getAccountInfo(account_id);
-                if (accountInfo.callModel->hasCall(c)) {
-                    const auto& call = accountInfo.callModel->getCall(c);
-                    if (call.status != lrc::api::call::Status::PAUSED
-                        && call.status != lrc::api::call::Status::IN_PROGRESS) {
-                        // Ignore non active calls
-                        callsId.push_back(call.id);
-                        continue;
-                    }
-                    uri = QString(call.peerUri).remove("ring:");
-                    accountId = account_id;
-                    uris.push_back(uri);
-                    break;
+                if (!account->callModel->hasCall(c))
+                    continue;
+                const auto& call = account->callModel->getCall(c);
+                if (call.status != lrc::api::call::Status::PAUSED
+                    && call.status != lrc::api::call::Status::IN_PROGRESS) {
+                    // Ignore non active calls
+                    continue;
                 }
+                uri = QString(call.peerUri).remove("ring:");
+                accountId = account->id;
+                busyUris_.emplace(uri.toStdString());
+                break;
             } catch (...) {}
         }
-        auto isPresent = callsId.contains(c);
-        if (c == callToRender || isPresent) {
+        if (uri.isEmpty() || c == callToRender || subcalls.find(c.toStdString()) != subcalls.end())
             continue;
-        }
 
-        if (first) {
-            add_title(_("Current calls (all accounts)"));
-            first = false;
-        }
-        if (!uri.isEmpty()) {
-            add_present_contact(uri, c, RowType::CALL, accountId);
-        }
+        auto key = invite_key(RowType::CALL, c);
+        keys.emplace(key);
+        if (inviteCandidates_.find(key) == inviteCandidates_.end())
+            addInviteCandidate(key, {RowType::CALL, c, uri.toStdString(), {}, add_present_contact(uri, accountId), accountId});
+        placeInviteCandidate(key, ++order);
     }
 
-    first = true;
+    // the calls and conferences ended
+    std::vector<std::string> ended;
+    for (const auto& [key, candidate] : inviteCandidates_)
+        if (candidate.type != RowType::CONTACT && keys.find(key) == keys.end())
+            ended.emplace_back(key);
+    for (const auto& key : ended)
+        removeInviteCandidate(key);
+
+    gtk_list_box_invalidate_sort(GTK_LIST_BOX(widgets->list_conversations_invite));
+}
+
+void
+CppImpl::updateContactCandidates()
+{
+    std::unordered_set<std::string> keys;
+    contactsOrder_ = 0;
     for (const auto& c : (*accountInfo)->conversationModel->getFilteredConversations((*accountInfo)->profileInfo.type).get()) {
         auto contacts = (*accountInfo)->conversationModel->peersForConversation(c.get().uid);
-        if (contacts.empty()) continue;
-        try {
-            auto participant = contacts.front();
-            auto contactInfo = (*accountInfo)->contactModel->getContact(participant);
-            auto isPresent = std::find(uris.cbegin(), uris.cend(), participant) != uris.cend();
-            if (!isPresent
-                && ((*accountInfo)->profileInfo.type == lrc::api::profile::Type::SIP || contactInfo.isPresent)) {
-                if (first) {
-                    add_title(_("Online contacts"));
-                    first = false;
-                }
-                add_present_contact(participant, participant, RowType::CONTACT, (*accountInfo)->id);
+        if (contacts.empty() || !updateContactCandidate(contacts.front()))
+            continue;
+        // in the order of the conversations
+        auto key = invite_key(RowType::CONTACT, contacts.front());
+        keys.emplace(key);
+        placeInviteCandidate(key, ++contactsOrder_);
+    }
+
+    // the contacts without conversation anymore
+    std::vector<std::string> gone;
+    for (const auto& [key, candidate] : inviteCandidates_)
+        if (candidate.type == RowType::CONTACT && keys.find(key) == keys.end())
+            gone.emplace_back(key);
+    for (const auto& key : gone)
+        removeInviteCandidate(key);
+
+    gtk_list_box_invalidate_sort(GTK_LIST_BOX(widgets->list_conversations_invite));
+}
+
+bool
+CppImpl::updateContactCandidate(const QString& uri)
+{
+    auto key = invite_key(RowType::CONTACT, uri);
+    auto present = false;
+    try {
+        const auto& contactInfo = (*accountInfo)->contactModel->getContact(uri);
+        present = (*accountInfo)->profileInfo.type == lrc::api::profile::Type::SIP || contactInfo.isPresent;
+    } catch (...) {}
+
+    if (!present) {
+        removeInviteCandidate(key);
+        return false;
+    }
+    if (inviteCandidates_.find(key) == inviteCandidates_.end()) {
+        addInviteCandidate(key, {RowType::CONTACT, uri, uri.toStdString(), {},
+                                 add_present_contact(uri, (*accountInfo)->id), (*accountInfo)->id});
+        placeInviteCandidate(key, ++contactsOrder_);
+    }
+    return true;
+}
+
+void
+CppImpl::addInviteCandidate(const std::string& key, InviteCandidate&& candidate)
+{
+    if (!candidate.row)
+        return;
+
+    auto* label = get_address_label(GTK_LIST_BOX_ROW(candidate.row));
+    candidate.search = lowercase(gtk_label_get_text(label));
+    for (const auto& trigram : trigrams(candidate.search))
+        inviteTrigrams_[trigram].emplace(key);
+
+    g_object_set_data_full(G_OBJECT(candidate.row), "invite_key", g_strdup(key.c_str()), g_free);
+    gtk_widget_show_all(candidate.row);
+    inviteCandidates_[key] = std::move(candidate);
+}
+
+void
+CppImpl::removeInviteCandidate(const std::string& key)
+{
+    auto it = inviteCandidates_.find(key);
+    if (it == inviteCandidates_.end())
+        return;
+
+    for (const auto& trigram : trigrams(it->second.search)) {
+        auto keys = inviteTrigrams_.find(trigram);
+        if (keys == inviteTrigrams_.end())
+            continue;
+        keys->second.erase(key);
+        if (keys->second.empty())
+            inviteTrigrams_.erase(keys);
+    }
+    unmatchInviteCandidate(key);
+    gtk_container_remove(GTK_CONTAINER(widgets->list_conversations_invite), it->second.row);
+    inviteCandidates_.erase(it);
+}
+
+void
+CppImpl::placeInviteCandidate(const std::string& key, guint order)
+{
+    auto it = inviteCandidates_.find(key);
+    if (it != inviteCandidates_.end())
+        g_object_set_data(G_OBJECT(it->second.row), "invite_rank",
+                          GUINT_TO_POINTER(invite_rank(it->second.type, order)));
+}
+
+/**
+ * Build again the rows showing a peer, after its profile changed. Their
+ * label, and what the filter matches, come from the profile.
+ */
+void
+CppImpl::refreshPeerCandidates(const QString& uri)
+{
+    std::vector<std::string> keys;
+    for (const auto& [key, candidate] : inviteCandidates_)
+        if (candidate.type != RowType::CONFERENCE && candidate.peer == uri.toStdString()
+            && candidate.account == (*accountInfo)->id)
+            keys.emplace_back(key);
+
+    for (const auto& key : keys) {
+        auto candidate = inviteCandidates_.at(key);
+        auto rank = g_object_get_data(G_OBJECT(candidate.row), "invite_rank");
+        removeInviteCandidate(key);
+        candidate.search.clear();
+        candidate.row = add_present_contact(uri, candidate.account);
+        if (!candidate.row)
+            continue;
+        g_object_set_data(G_OBJECT(candidate.row), "invite_rank", rank);
+        auto type = candidate.type;
+        addInviteCandidate(key, std::move(candidate));
+        filterInviteCandidate(key, type);
+    }
+}
+
+bool
+CppImpl::isInviteCandidateShown(const std::string& key, const InviteCandidate& candidate) const
+{
+    if (candidate.type == RowType::CONTACT && busyUris_.find(candidate.peer) != busyUris_.end())
+        return false;
+    return !inviteFiltered_ || inviteMatches_.find(key) != inviteMatches_.end();
+}
+
+void
+CppImpl::matchInviteCandidate(const std::string& key, const InviteCandidate& candidate)
+{
+    if (candidate.search.find(inviteFilter_) == std::string::npos)
+        return;
+    if (inviteFiltered_)
+        inviteMatches_.emplace(key);
+    if (isInviteCandidateShown(key, candidate)) {
+        ++sectionMatches_[candidate.type];
+        shownMatches_.emplace(key, candidate.type);
+    }
+}
+
+void
+CppImpl::unmatchInviteCandidate(const std::string& key)
+{
+    inviteMatches_.erase(key);
+    auto it = shownMatches_.find(key);
+    if (it == shownMatches_.end())
+        return;
+    --sectionMatches_[it->second];
+    shownMatches_.erase(it);
+}
+
+void
+CppImpl::filterInviteCandidates()
+{
+    inviteFilter_ = lowercase(gtk_entry_get_text(GTK_ENTRY(widgets->conversation_filter_entry)));
+    const auto& filter = inviteFilter_;
+    inviteFiltered_ = !filter.empty();
+    inviteMatches_.clear();
+    shownMatches_.clear();
+    sectionMatches_.clear();
+
+    if (filter.size() < 3) {
+        for (const auto& [key, candidate] : inviteCandidates_)
+            matchInviteCandidate(key, candidate);
+    } else {
+        // only the candidates with the least common trigram of the filter
+        // may contain it
+        static const std::unordered_set<std::string> none;
+        const std::unordered_set<std::string>* keys = nullptr;
+        for (const auto& trigram : trigrams(filter)) {
+            auto it = inviteTrigrams_.find(trigram);
+            if (it == inviteTrigrams_.end()) {
+                keys = &none;
+                break;
             }
-        } catch (...) {}
+            if (!keys || it->second.size() < keys->size())
+                keys = &it->second;
+        }
+        for (const auto& key : *keys)
+            matchInviteCandidate(key, inviteCandidates_.at(key));
     }
+
+    gtk_list_box_invalidate_filter(GTK_LIST_BOX(widgets->list_conversations_invite));
 }
 
+/**
+ * Filter again the row of a single candidate, and the title of its section.
+ */
 void
-CppImpl::add_title(const QString& title) {
+CppImpl::filterInviteCandidate(const std::string& key, RowType section)
+{
+    unmatchInviteCandidate(key);
+    auto it = inviteCandidates_.find(key);
+    if (it != inviteCandidates_.end()) {
+        matchInviteCandidate(key, it->second);
+        gtk_list_box_row_changed(GTK_LIST_BOX_ROW(it->second.row));
+    }
+    gtk_list_box_row_changed(GTK_LIST_BOX_ROW(sectionTitles_[section]));
+}
+
+GtkWidget*
+CppImpl::add_title(const QString& title, RowType section) {
     auto* box_item = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 0);
     auto* avatar = gtk_image_new_from_icon_name("pan-down-symbolic", GTK_ICON_SIZE_MENU);
     auto* info = gtk_label_new(nullptr);
@@ -1252,23 +1540,21 @@ CppImpl::add_title(const QString& title) {
     g_object_set(G_OBJECT(info), "ellipsize", PANGO_ELLIPSIZE_END, NULL);
     gtk_list_box_insert(GTK_LIST_BOX(widgets->list_conversations_invite), GTK_WIDGET(box_item), -1);
 
-    titles_.emplace_back(title.toStdString());
+    auto* row = gtk_widget_get_parent(box_item);
+    g_object_set_data(G_OBJECT(row), "invite_section", GINT_TO_POINTER(static_cast<int>(section) + 1));
+    g_object_set_data(G_OBJECT(row), "invite_rank", GUINT_TO_POINTER(invite_rank(section, 0)));
+    return row;
 }
 
-void
-CppImpl::add_present_contact(const QString& uri, const QString& custom_data, RowType custom_type, const QString& accountId)
+GtkWidget*
+CppImpl::add_present_contact(const QString& uri, const QString& accountId)
 {
     QString bestName = uri, bestUri = uri;
-    GdkPixbuf *default_avatar = draw_generate_avatar("", "");
-    GdkPixbuf *photo = draw_scale_and_frame(
-        default_avatar,
-        QSize(48, 48), true, IconStatus::PRESENT);
-    g_object_unref(default_avatar);
+    GdkPixbuf *photo = nullptr;
 
     try {
         auto &accInfo = lrc_.getAccountModel().getAccountInfo(accountId);
-        auto contactInfo = accInfo.contactModel->getContact(uri);
-        auto photostr = contactInfo.profileInfo.avatar;
+        const auto& contactInfo = accInfo.contactModel->getContact(uri);
         auto alias = contactInfo.profileInfo.alias;
 
         if (!alias.isEmpty()) {
@@ -1279,33 +1565,19 @@ CppImpl::add_present_contact(const QString& uri, const QString& custom_data, Row
             bestUri = contactInfo.registeredName;
         }
 
-        if (!photostr.isEmpty()) {
-            QByteArray byteArray = photostr.toUtf8();
-            GdkPixbuf *p = draw_person_photo(byteArray);
-            if (p) {
-                g_object_unref(photo);
-                photo = draw_scale_and_frame(
-                    p, QSize(48, 48), true, IconStatus::PRESENT);
-                g_object_unref(p);
-            }
-        } else {
-            auto name = alias.isEmpty()? contactInfo.registeredName : alias;
-            auto firstLetter = (name == contactInfo.profileInfo.uri || name.isEmpty()) ?
-            "" : QString(name.at(0));  // NOTE best way to be compatible with UTF-8
-            auto fullUri = contactInfo.profileInfo.uri;
-            if (accInfo.profileInfo.type != lrc::api::profile::Type::SIP)
-                fullUri = "ring:" + fullUri;
-            else
-                fullUri = "sip:" + fullUri;
-            GdkPixbuf *photo_tmp = draw_generate_avatar(
-                firstLetter.toStdString(), fullUri.toStdString());
-            photo = draw_scale_and_frame(
-                photo_tmp, QSize(48, 48), true, IconStatus::PRESENT);
-            g_object_unref(photo_tmp);
-        }
+        auto name = alias.isEmpty()? contactInfo.registeredName : alias;
+        if (name == contactInfo.profileInfo.uri)
+            name.clear();
+        auto fullUri = (accInfo.profileInfo.type != lrc::api::profile::Type::SIP ? QString("ring:") : QString("sip:"))
+            + contactInfo.profileInfo.uri;
+        photo = avatar_cache_get(contactInfo.profileInfo.uri.toStdString(), name.toStdString(),
+                                 fullUri.toStdString(), contactInfo.profileInfo.avatar.toStdString(),
+                                 QSize(48, 48), true, IconStatus::PRESENT);
     } catch (const std::out_of_range&) {
         // ContactModel::getContact() exception
     }
+    if (!photo)
+        photo = avatar_cache_get("", "", "", "", QSize(48, 48), true, IconStatus::PRESENT);
 
     gchar* text = nullptr;
     if (uri != bestName) {
@@ -1328,18 +1600,17 @@ CppImpl::add_present_contact(const QString& uri, const QString& custom_data, Row
     g_object_unref(photo);
     auto* info = gtk_label_new(nullptr);
     gtk_label_set_markup(GTK_LABEL(info), text);
+    g_free(text);
     gtk_container_add(GTK_CONTAINER(box_item), GTK_WIDGET(avatar));
     gtk_container_add(GTK_CONTAINER(box_item), GTK_WIDGET(info));
     g_object_set(G_OBJECT(info), "ellipsize", PANGO_ELLIPSIZE_END, NULL);
 
-    g_object_set_data(G_OBJECT(info), "custom_type", GINT_TO_POINTER(custom_type));
-    g_object_set_data(G_OBJECT(info), "custom_data", (void*)g_strdup(qUtf8Printable(custom_data)));
-
     gtk_list_box_insert(GTK_LIST_BOX(widgets->list_conversations_invite), GTK_WIDGET(box_item), -1);
+    return gtk_widget_get_parent(box_item);
 }
 
-void
-CppImpl::add_conference(const VectorString& uris, const QString& custom_data, const QString& accountId)
+GtkWidget*
+CppImpl::add_conference(const VectorString& uris, const QString& accountId)
 {
     GError *error = nullptr;
     GdkPixbuf *default_avatar = gdk_pixbuf_new_from_resource_at_scale(
@@ -1347,7 +1618,7 @@ CppImpl::add_conference(const VectorString& uris, const QString& custom_data, co
     if (!default_avatar) {
         g_debug("Could not load icon: %s", error->message);
         g_clear_error(&error);
-        return;
+        return nullptr;
     }
     GdkPixbuf *photo = draw_scale_and_frame(default_avatar, QSize(50, 50));
     g_object_unref(default_avatar);
@@ -1389,14 +1660,13 @@ CppImpl::add_conference(const VectorString& uris, const QString& custom_data, co
     g_object_unref(photo);
     auto* info = gtk_label_new(nullptr);
     gtk_label_set_markup(GTK_LABEL(info), text);
+    g_free(text);
     gtk_container_add(GTK_CONTAINER(box_item), GTK_WIDGET(avatar));
     gtk_container_add(GTK_CONTAINER(box_item), GTK_WIDGET(info));
     g_object_set(G_OBJECT(info), "ellipsize", PANGO_ELLIPSIZE_END, NULL);
 
-    g_object_set_data(G_OBJECT(info), "custom_type", GINT_TO_POINTER(RowType::CONFERENCE));
-    g_object_set_data(G_OBJECT(info), "custom_data", (void*)g_strdup(qUtf8Printable(custom_data)));
-
     gtk_list_box_insert(GTK_LIST_BOX(widgets->list_conversations_invite), GTK_WIDGET(box_item), -1);
+    return gtk_widget_get_parent(box_item);
 }
 
 void
@@ -1534,6 +1804,7 @@ CppImpl::setCallInfo()
                 updateNameAndPhoto();
                 updateState();
             }
+            invalidateCallCandidates();
         });
 
     layout_change_connection = QObject::connect(
@@ -1541,12 +1812,34 @@ CppImpl::setCallInfo()
         &lrc::api::NewCallModel::onParticipantsChanged,
         [this] (const QString& callId) {
             update_participants_hovers(callId);
+            invalidateCallCandidates();
         });
 
+    // the presence of the contacts
+    presence_connection = QObject::connect(
+        &*(*accountInfo)->conversationModel,
+        &lrc::api::ConversationModel::conversationUpdated,
+        [this] (const QString& uid) {
+            try {
+                if (contactsDirty_) return; // caught up when the list opens
+                auto contacts = (*accountInfo)->conversationModel->peersForConversation(uid);
+                if (contacts.empty()) return;
+                // only the row of this contact changes
+                updateContactCandidate(contacts.front());
+                filterInviteCandidate(invite_key(RowType::CONTACT, contacts.front()), RowType::CONTACT);
+            } catch (...) {}
+        });
+
+    contacts_connection = QObject::connect(
+        &*(*accountInfo)->conversationModel,
+        &lrc::api::ConversationModel::modelChanged,
+        [this] { invalidateContactCandidates(); });
+
     update_vcard_connection = QObject::connect(
         &*(*accountInfo)->contactModel,
         &lrc::api::ContactModel::contactAdded,
         [this] (const QString& uri) {
+            refreshPeerCandidates(uri);
             auto contacts = (*accountInfo)->conversationModel->peersForConversation(conversation->uid);
             if (contacts.empty()) return;
             if (uri == contacts.front()) {
@@ -1741,15 +2034,14 @@ void
 CppImpl::update_participants_hovers(const QString& callId)
 {
     if (callId == conversation->callId or callId == conversation->confId) {
-        // Remove previouses hovers, because they are now invalid
-        video_widget_remove_hovers(
-            VIDEO_WIDGET(widgets->video_widget)
-        );
         // Update callInfo for the video_widget
         video_widget_set_call_info(VIDEO_WIDGET(widgets->video_widget), *accountInfo, callId);
         try {
             auto call = (*accountInfo)->callModel->getCall(callId);
-            // Create participant hovers
+            // Update the participant hovers, the video widget keeps the ones
+            // still in the conference
+            std::vector<QJsonObject> participants;
+            participants.reserve(call.participantsInfos.size());
             for (const auto& participant: call.participantsInfos) {
                 QJsonObject data;
                 data["x"] = participant["x"].toInt();
@@ -1775,11 +2067,10 @@ CppImpl::update_participants_hovers(const QString& callId)
                 }
                 data["bestName"] = bestName;
                 data["uri"] = participant["uri"];
-                video_widget_add_participant_hover(
-                    VIDEO_WIDGET(widgets->video_widget),
-                    data
-                );
+                participants.emplace_back(std::move(data));
             }
+            video_widget_update_participant_hovers(VIDEO_WIDGET(widgets->video_widget),
+                                                   participants);
             // Update preview visibility, show preview if the call is not hold and
             // not a conference host or participant
             video_widget_set_preview_visible(VIDEO_WIDGET(widgets->video_widget),
@@ -1787,6 +2078,7 @@ CppImpl::update_participants_hovers(const QString& callId)
                         && call.type != lrc::api::call::Type::CONFERENCE
                         && call.participantsInfos.empty());
         } catch (...) {
+            video_widget_remove_hovers(VIDEO_WIDGET(widgets->video_widget));
             g_warning("Can't set preview visible for inexistent call");
         }
     }
@@ -1891,64 +2183,75 @@ CppImpl::updateNameAndPhoto()
     }
 }
 
+static void
+set_label_text(GtkWidget* label, const gchar* text)
+{
+    // setting the same text would still resize the label
+    if (g_strcmp0(gtk_label_get_text(GTK_LABEL(label)), text) != 0)
+        gtk_label_set_text(GTK_LABEL(label), text);
+}
+
 void
 CppImpl::updateSmartInfo()
 {
-    if (!SmartInfoHub::instance().isConference()) {
-        gchar* general_information = g_strdup_printf(
-            "Call ID: %s", SmartInfoHub::instance().callID().toStdString().c_str());
-        gtk_label_set_text(GTK_LABEL(widgets->label_smartinfo_general_information), general_information);
-        g_free(general_information);
-
-        gchar* description = g_strdup_printf("You\n"
-                                             "Framerate:\n"
-                                             "Video codec:\n"
-                                             "Audio codec:\n"
-                                             "Resolution:\n\n"
-                                             "Peer\n"
-                                             "Framerate:\n"
-                                             "Video codec:\n"
-                                             "Audio codec:\n"
-                                             "Resolution:");
-        gtk_label_set_text(GTK_LABEL(widgets->label_smartinfo_description),description);
-        g_free(description);
-
-        gchar* value = g_strdup_printf("\n%f\n%s\n%s\n%dx%d\n\n\n%f\n%s\n%s\n%dx%d",
-                                       (double)SmartInfoHub::instance().localFps(),
-                                       SmartInfoHub::instance().localVideoCodec().toStdString().c_str(),
-                                       SmartInfoHub::instance().localAudioCodec().toStdString().c_str(),
-                                       SmartInfoHub::instance().localWidth(),
-                                       SmartInfoHub::instance().localHeight(),
-                                       (double)SmartInfoHub::instance().remoteFps(),
-                                       SmartInfoHub::instance().remoteVideoCodec().toStdString().c_str(),
-                                       SmartInfoHub::instance().remoteAudioCodec().toStdString().c_str(),
-                                       SmartInfoHub::instance().remoteWidth(),
-                                       SmartInfoHub::instance().remoteHeight());
-        gtk_label_set_text(GTK_LABEL(widgets->label_smartinfo_value),value);
-        g_free(value);
+    if (!gtk_widget_get_visible(widgets->vbox_call_smartInfo))
+        return;
+
+    auto& hub = SmartInfoHub::instance();
+    int isConference = hub.isConference();
+    if (isConference != smartinfo_conference) {
+        smartinfo_conference = isConference;
+        gtk_label_set_text(GTK_LABEL(widgets->label_smartinfo_description),
+                           isConference ? "You\n"
+                                          "Framerate:\n"
+                                          "Video codec:\n"
+                                          "Audio codec:\n"
+                                          "Resolution:"
+                                        : "You\n"
+                                          "Framerate:\n"
+                                          "Video codec:\n"
+                                          "Audio codec:\n"
+                                          "Resolution:\n\n"
+                                          "Peer\n"
+                                          "Framerate:\n"
+                                          "Video codec:\n"
+                                          "Audio codec:\n"
+                                          "Resolution:");
+    }
+
+    auto callId = hub.callID().toUtf8();
+    gchar* general_information = g_strdup_printf(isConference ? "Conference ID: %s" : "Call ID: %s",
+                                                 callId.constData());
+    set_label_text(widgets->label_smartinfo_general_information, general_information);
+    g_free(general_information);
+
+    auto localVideoCodec = hub.localVideoCodec().toUtf8();
+    auto localAudioCodec = hub.localAudioCodec().toUtf8();
+    gchar* value;
+    if (isConference) {
+        value = g_strdup_printf("\n%f\n%s\n%s\n%dx%d",
+                                (double)hub.localFps(),
+                                localVideoCodec.constData(),
+                                localAudioCodec.constData(),
+                                hub.localWidth(),
+                                hub.localHeight());
     } else {
-        gchar* general_information = g_strdup_printf(
-            "Conference ID: %s", SmartInfoHub::instance().callID().toStdString().c_str());
-        gtk_label_set_text(GTK_LABEL(widgets->label_smartinfo_general_information), general_information);
-        g_free(general_information);
-
-        gchar* description = g_strdup_printf("You\n"
-                                             "Framerate:\n"
-                                             "Video codec:\n"
-                                             "Audio codec:\n"
-                                             "Resolution:");
-        gtk_label_set_text(GTK_LABEL(widgets->label_smartinfo_description),description);
-        g_free(description);
-
-        gchar* value = g_strdup_printf("\n%f\n%s\n%s\n%dx%d",
-                                       (double)SmartInfoHub::instance().localFps(),
-                                       SmartInfoHub::instance().localVideoCodec().toStdString().c_str(),
-                                       SmartInfoHub::instance().localAudioCodec().toStdString().c_str(),
-                                       SmartInfoHub::instance().localWidth(),
-                                       SmartInfoHub::instance().localHeight());
-        gtk_label_set_text(GTK_LABEL(widgets->label_smartinfo_value),value);
-        g_free(value);
+        auto remoteVideoCodec = hub.remoteVideoCodec().toUtf8();
+        auto remoteAudioCodec = hub.remoteAudioCodec().toUtf8();
+        value = g_strdup_printf("\n%f\n%s\n%s\n%dx%d\n\n\n%f\n%s\n%s\n%dx%d",
+                                (double)hub.localFps(),
+                                localVideoCodec.constData(),
+                                localAudioCodec.constData(),
+                                hub.localWidth(),
+                                hub.localHeight(),
+                                (double)hub.remoteFps(),
+                                remoteVideoCodec.constData(),
+                                remoteAudioCodec.constData(),
+                                hub.remoteWidth(),
+                                hub.remoteHeight());
     }
+    set_label_text(widgets->label_smartinfo_value, value);
+    g_free(value);
 }
 
 void
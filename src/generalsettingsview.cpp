@@ -31,6 +31,7 @@
 
 // Jami Client
 #include "utils/files.h"
+#include "utils/styleregistry.h"
 #include "avatarmanipulation.h"
 
 namespace { namespace details {
@@ -558,12 +559,6 @@ general_settings_view_new(GtkWidget* main_window_pointer, lrc::api::AVModel& avM
     g_signal_connect_swapped(priv->button_choose_downloads_directory, "clicked", G_CALLBACK(choose_downloads_directory), self);
 
     // CSS styles
-    auto provider = gtk_css_provider_new();
-    std::string css = ".button_red { color: white; background: #dc3a37; border: 0; }";
-    css += ".button_red:hover { background: #dc2719; }";
-    gtk_css_provider_load_from_data(provider, css.c_str(), -1, nullptr);
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/generalsettingsview.css");
     return (GtkWidget *)self;
 }
@@ -46,6 +46,7 @@
 #include "messagingwidget.h"
 #include "utils/drawing.h"
 #include "utils/files.h"
+#include "utils/styleregistry.h"
 
 struct _IncomingCallView
 {
@@ -176,19 +177,7 @@ incoming_call_view_init(IncomingCallView *view)
 {
     gtk_widget_init_template(GTK_WIDGET(view));
 
-    auto provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider,
-        ".flat-button { border: 0; border-radius: 50%; transition: all 0.3s ease; } \
-        .red-button { background: #dc3a37; } \
-        .green-button { background: #27ae60; } \
-        .red-button:hover { background: #dc2719; } \
-        .green-button:hover { background: #219d55; }",
-        -1, nullptr
-    );
-
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/incomingcallview.css");
 
     auto priv = INCOMING_CALL_VIEW_GET_PRIVATE(view);
 
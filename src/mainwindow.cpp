@@ -27,7 +27,11 @@
 #include <algorithm>
 #include <sstream>
 #include <functional>
+#include <list>
 #include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 // Qt
 #include <QSize>
@@ -60,9 +64,16 @@
 #include "pluginsettingsview.h"
 #include "incomingcallview.h"
 #include "mediasettingsview.h"
+#include "unifiedconversationsview.h"
 #include "welcomeview.h"
+#include "utils/avatarcache.h"
+#include "utils/calltelemetry.h"
 #include "utils/drawing.h"
 #include "utils/files.h"
+#include "utils/historypruner.h"
+#include "utils/messageindex.h"
+#include "utils/startuptracer.h"
+#include "utils/styleregistry.h"
 #include "notifier.h"
 #include "accountinfopointer.h"
 #include "notifier.h"
@@ -174,6 +185,10 @@ static constexpr const char* MEDIA_SETTINGS_VIEW_NAME          = "media";
 static constexpr const char* NEW_ACCOUNT_SETTINGS_VIEW_NAME    = "account";
 static constexpr const char* PLUGIN_SETTINGS_VIEW_NAME          = "plugin";
 
+/* global message search */
+static constexpr glong       MESSAGE_SEARCH_MIN_LENGTH          = 2;
+static constexpr std::size_t MESSAGE_SEARCH_MAX_RESULTS         = 50;
+
 inline namespace helpers
 {
 
@@ -242,69 +257,6 @@ print_account_and_state(GtkCellLayout*,
     g_free(text);
 }
 
-static void
-render_account_avatar(GtkCellLayout*,
-                      GtkCellRenderer *cell,
-                      GtkTreeModel *model,
-                      GtkTreeIter *iter,
-                      gpointer)
-{
-    gchar *id;
-    gchar* avatar;
-    gchar* status;
-
-    gtk_tree_model_get (model, iter,
-                        0 /* col# */, &id /* data */,
-                        1 /* col# */, &status /* data */,
-                        2 /* col# */, &avatar /* data */,
-                        -1);
-
-    if (g_strcmp0("", id) == 0) {
-        g_free(status);
-        g_free(avatar);
-        g_free(id);
-
-        GdkPixbuf* icon = gdk_pixbuf_new_from_resource("/net/jami/JamiGnome/add-device", nullptr);
-        g_object_set(G_OBJECT(cell), "width", 32, nullptr);
-        g_object_set(G_OBJECT(cell), "height", 32, nullptr);
-        g_object_set(G_OBJECT(cell), "pixbuf", icon, nullptr);
-        return;
-    }
-
-    IconStatus iconStatus = IconStatus::INVALID;
-    std::string statusStr = status? status : "";
-    if (statusStr == "DISCONNECTED") {
-        iconStatus = IconStatus::DISCONNECTED;
-    } else if (statusStr == "TRYING") {
-        iconStatus = IconStatus::TRYING;
-    } else if (statusStr == "CONNECTED") {
-        iconStatus = IconStatus::CONNECTED;
-    }
-    GdkPixbuf *default_avatar = draw_generate_avatar("", "");
-    GdkPixbuf *photo = draw_scale_and_frame(default_avatar, QSize(32, 32), true, iconStatus);
-    g_object_unref(default_avatar);
-
-    std::string photostr = avatar;
-    if (!photostr.empty()) {
-        QByteArray byteArray(photostr.c_str(), photostr.length());
-        GdkPixbuf *p = draw_person_photo(byteArray);
-        if (p) {
-            g_object_unref(photo);
-            photo = draw_scale_and_frame(p, QSize(32, 32), true, iconStatus);
-            g_object_unref(p);
-        }
-    }
-
-    g_object_set(G_OBJECT(cell), "width", 32, nullptr);
-    g_object_set(G_OBJECT(cell), "height", 32, nullptr);
-    g_object_set(G_OBJECT(cell), "pixbuf", photo, nullptr);
-
-    g_object_unref(photo);
-    g_free(status);
-    g_free(avatar);
-    g_free(id);
-}
-
 inline static void
 foreachLrcAccount(const lrc::api::Lrc& lrc,
                   const std::function<void(const lrc::api::account::Info&)>& func)
@@ -316,8 +268,78 @@ foreachLrcAccount(const lrc::api::Lrc& lrc,
     }
 }
 
+static const gchar*
+account_status_name(lrc::api::account::Status status)
+{
+    switch (status) {
+        case lrc::api::account::Status::ERROR_NEED_MIGRATION:
+            return "NEEDS MIGRATION";
+        case lrc::api::account::Status::INVALID:
+        case lrc::api::account::Status::UNREGISTERED:
+            return "DISCONNECTED";
+        case lrc::api::account::Status::INITIALIZING:
+        case lrc::api::account::Status::TRYING:
+            return "TRYING";
+        case lrc::api::account::Status::REGISTERED:
+            return "CONNECTED";
+    }
+    return "";
+}
+
 } // namespace helpers
 
+// status changes of the accounts are shown once they settled, the network may flap
+static constexpr guint ACCOUNT_SELECTOR_REFRESH_MS = 500;
+
+// conversation lists kept for the last used accounts, so that switching back is instant
+static constexpr std::size_t MAX_CACHED_CONVERSATIONS_VIEWS = 4;
+// rough memory bound, each row holds an avatar and a few strings
+static constexpr gint MAX_CACHED_CONVERSATIONS_ROWS = 5000;
+
+/**
+ * The conversations and the contact requests lists of an account.
+ */
+struct ConversationsViews
+{
+    std::string accountId;
+    // the views keep a pointer to it, its address must outlive them
+    std::unique_ptr<AccountInfoPointer> accountInfo;
+    GtkWidget* conversations = nullptr;
+    GtkWidget* contactRequests = nullptr;
+
+    gint rows() const {
+        gint rows = 0;
+        for (auto* view : {conversations, contactRequests}) {
+            if (auto* model = gtk_tree_view_get_model(GTK_TREE_VIEW(view)))
+                rows += gtk_tree_model_iter_n_children(model, nullptr);
+        }
+        return rows;
+    }
+
+    // drop the views and the reference held while they are out of the window
+    void destroyDetached() {
+        for (auto* view : {conversations, contactRequests}) {
+            gtk_widget_destroy(view);
+            g_object_unref(view);
+        }
+    }
+};
+
+/**
+ * What a chat notification needs, looked up once per burst of messages.
+ */
+struct ChatNotification
+{
+    std::string conversation;
+    std::string avatar;
+    std::string uri;
+    std::string name;
+    QString lastBody;
+    unsigned count = 0; // messages since the notification was shown first
+    bool changed = false; // received while rate limited
+    guint flushSource = 0;
+};
+
 class CppImpl
 {
 public:
@@ -338,6 +360,15 @@ public:
     void enterSettingsView();
     void leaveSettingsView();
     void updateUrgency();
+    void attachMessageIndex(const lrc::api::account::Info& accountInfo);
+    void updateCallTelemetry();
+    GtkWidget* settingsView(const char* name, bool build = true);
+    void prebuildSettingsViews();
+    void detachConversationsViews(const std::string& accountIdToFlagFreeable);
+    void attachConversationsViews(const std::string& accountId);
+    void trimConversationsViewsCache();
+    void showUnifiedConversations(bool show);
+    void refreshNotebookTabs();
 
     std::string getCurrentUid();
     void forCurrentConversation(const std::function<void(const lrc::api::conversation::Info&)>& func);
@@ -354,6 +385,7 @@ public:
     MainWindowPrivate* widgets = nullptr;
 
     std::unique_ptr<lrc::api::Lrc> lrc_;
+    std::unique_ptr<HistoryPruner> historyPruner_;
     AccountInfoPointer accountInfo_ = nullptr;
     AccountInfoPointer accountInfoForMigration_ = nullptr;
     std::optional<std::reference_wrapper<lrc::api::conversation::Info>> chatViewConversation_;
@@ -395,6 +427,41 @@ public:
 
     bool isCreatingAccount {false};
     QHash<QString, QMetaObject::Connection> pendingConferences_;
+
+    // settings views are only built when first shown, or when idle
+    std::vector<std::pair<const char*, std::function<GtkWidget*()>>> settingsViewFactories_;
+    gulong firstDrawHandler_ = 0;
+    guint prebuildSettingsSource_ = 0;
+
+    // lists of the current account, and the detached ones, most recent first
+    ConversationsViews conversationsViews_;
+    std::list<ConversationsViews> conversationsViewsCache_;
+
+    // chat notifications being shown, by notification id (one per conversation)
+    std::unordered_map<std::string, ChatNotification> chatNotifications_;
+
+    // optional page listing the conversations of every account
+    GtkWidget* unifiedConversationsPage_ = nullptr;
+    GtkWidget* unifiedConversations_ = nullptr;
+
+    // rows of the account selector, kept and updated in place
+    GtkListStore* accountSelectorStore_ = nullptr;
+    guint accountSelectorRefreshSource_ = 0;
+    void scheduleAccountSelectorRefresh();
+    void setAccountSelectorRow(GtkTreeIter* iter, const lrc::api::account::Info& accountInfo);
+
+    // the account selector draws its rows from these, the icon of an account
+    // is drawn again once its avatar or its status changed
+    struct AccountIcon
+    {
+        std::string status;
+        guint64 avatar;
+        std::shared_ptr<GdkPixbuf> pixbuf;
+    };
+    std::unordered_map<std::string, AccountIcon> accountIcons_;
+    std::shared_ptr<GdkPixbuf> addAccountIcon_;
+    std::shared_ptr<GdkPixbuf> rendezVousIcon_;
+    GdkPixbuf* accountIcon(const std::string& id, const gchar* status, guint64 avatar);
 private:
     CppImpl() = delete;
     CppImpl(const CppImpl&) = delete;
@@ -428,12 +495,62 @@ private:
     void slotNewInteraction(const std::string& accountId, const std::string& conversation,
                                 const QString& interactionId, const lrc::api::interaction::Info& interaction);
     void slotCloseInteraction(const std::string& accountId, const std::string& conversation, const QString& interactionId);
+    void showChatNotification(const std::string& notifId);
     void slotProfileUpdated(const std::string& id);
 };
 
 inline namespace gtk_callbacks
 {
 
+static void
+render_account_avatar(GtkCellLayout*,
+                      GtkCellRenderer *cell,
+                      GtkTreeModel *model,
+                      GtkTreeIter *iter,
+                      MainWindowPrivate* priv)
+{
+    gchar *id;
+    gchar* status;
+    guint64 avatar;
+
+    gtk_tree_model_get (model, iter,
+                        0 /* col# */, &id /* data */,
+                        1 /* col# */, &status /* data */,
+                        2 /* col# */, &avatar /* data */,
+                        -1);
+
+    GdkPixbuf* icon;
+    if (g_strcmp0("", id) == 0) {
+        if (!priv->cpp->addAccountIcon_)
+            priv->cpp->addAccountIcon_.reset(
+                gdk_pixbuf_new_from_resource("/net/jami/JamiGnome/add-device", nullptr),
+                g_object_unref);
+        icon = priv->cpp->addAccountIcon_.get();
+    } else {
+        icon = priv->cpp->accountIcon(id, status, avatar);
+    }
+
+    g_object_set(G_OBJECT(cell), "width", 32, nullptr);
+    g_object_set(G_OBJECT(cell), "height", 32, nullptr);
+    g_object_set(G_OBJECT(cell), "pixbuf", icon, nullptr);
+
+    g_free(status);
+    g_free(id);
+}
+
+static gboolean
+refresh_account_selector(gpointer data)
+{
+    auto* cpp = static_cast<CppImpl*>(data);
+    cpp->accountSelectorRefreshSource_ = 0;
+    auto currentIdx = gtk_combo_box_get_active(GTK_COMBO_BOX(cpp->widgets->combobox_account_selector));
+    if (currentIdx == -1)
+        currentIdx = 0; // If no account selected, select the first account
+    // NOTE: Because the currentIdx can change (accounts can be re-ordered), force to select the accountInfo_->id
+    cpp->refreshAccountSelectorWidget(currentIdx, cpp->accountInfo_ ? cpp->accountInfo_->id.toStdString() : "");
+    return G_SOURCE_REMOVE;
+}
+
 static void
 render_rendezvous_mode(GtkCellLayout*,
                       GtkCellRenderer *cell,
@@ -453,10 +570,13 @@ render_rendezvous_mode(GtkCellLayout*,
         try {
             auto conf = priv->cpp->accountInfo_->accountModel->getAccountConfig(id);
             if (conf.isRendezVous) {
-                GdkPixbuf* icon = gdk_pixbuf_new_from_resource("/net/jami/JamiGnome/groups", nullptr);
+                if (!priv->cpp->rendezVousIcon_)
+                    priv->cpp->rendezVousIcon_.reset(
+                        gdk_pixbuf_new_from_resource("/net/jami/JamiGnome/groups", nullptr),
+                        g_object_unref);
                 g_object_set(G_OBJECT(cell), "width", 32, nullptr);
                 g_object_set(G_OBJECT(cell), "height", 32, nullptr);
-                g_object_set(G_OBJECT(cell), "pixbuf", icon, nullptr);
+                g_object_set(G_OBJECT(cell), "pixbuf", priv->cpp->rendezVousIcon_.get(), nullptr);
             } else {
                 g_object_set(G_OBJECT(cell), "pixbuf", nullptr, nullptr);
             }
@@ -549,6 +669,9 @@ on_redraw(GtkWidget*, cairo_t*, MainWindow* self)
     auto color = get_ambient_color(GTK_WIDGET(self));
     bool current_theme = use_dark_theme(color);
     conversations_view_set_theme(CONVERSATIONS_VIEW(priv->treeview_conversations), current_theme);
+    if (priv->cpp && priv->cpp->unifiedConversations_)
+        unified_conversations_view_set_theme(UNIFIED_CONVERSATIONS_VIEW(priv->cpp->unifiedConversations_),
+                                             current_theme);
     if (priv->useDarkTheme != current_theme) {
         welcome_set_theme(WELCOME_VIEW(priv->welcome_view), current_theme);
         welcome_update_view(WELCOME_VIEW(priv->welcome_view));
@@ -565,23 +688,28 @@ on_redraw(GtkWidget*, cairo_t*, MainWindow* self)
                           << (int)(color.green * 256)
                           << (int)(color.blue * 256);
 
-        auto provider = gtk_css_provider_new();
         std::string background_search_entry = "background: " + background.str() + ";";
         std::string css_style = ".search-entry-style { border: 0; border-radius: 0; } \
         .spinner-style { border: 0; background: white; } \
         .new-conversation-style { border: 0; " + background_search_entry + " transition: all 0.3s ease; border-radius: 0; } \
         .new-conversation-style:hover {  background: " + (priv->useDarkTheme ? "#003b4e" : "#bae5f0") + "; }";
-        gtk_css_provider_load_from_data(provider,
-            css_style.c_str(),
-            -1, nullptr
-        );
-        gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                                  GTK_STYLE_PROVIDER(provider),
-                                                  GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+        // replaces the one of the previous theme
+        style_registry_set("mainwindow", css_style);
     }
     return false;
 }
 
+static gboolean
+on_first_draw(GtkWidget* self, cairo_t*, gpointer)
+{
+    auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
+    g_signal_handler_disconnect(self, priv->cpp->firstDrawHandler_);
+    priv->cpp->firstDrawHandler_ = 0;
+    startup_tracer_mark("first frame");
+    priv->cpp->prebuildSettingsViews();
+    return GDK_EVENT_PROPAGATE;
+}
+
 gboolean
 on_migrating_dialog_redraw(GtkWidget* migrating_dialog, cairo_t*, MainWindow* win)
 {
@@ -682,8 +810,7 @@ on_account_changed(MainWindow* self)
             if (priv->cpp->accountInfo_)
                 priv->cpp->accountInfo_->accountModel->setTopAccount(accountId);
             priv->cpp->onAccountSelectionChange(accountId);
-            gtk_notebook_set_show_tabs(GTK_NOTEBOOK(priv->notebook_contacts),
-                priv->cpp->accountInfo_->conversationModel->hasPendingRequests());
+            priv->cpp->refreshNotebookTabs();
         }
         g_free(accountId);
     }
@@ -707,12 +834,17 @@ on_show_media_settings(GtkToggleButton* navbutton, MainWindow* self)
     g_return_if_fail(IS_MAIN_WINDOW(self));
     auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
 
-    if (gtk_toggle_button_get_active(navbutton)) {
-        media_settings_view_show_preview(MEDIA_SETTINGS_VIEW(priv->media_settings_view), TRUE);
-        gtk_stack_set_visible_child_name(GTK_STACK(priv->stack_main_view), MEDIA_SETTINGS_VIEW_NAME);
-        priv->last_settings_view = priv->media_settings_view;
+    auto active = gtk_toggle_button_get_active(navbutton);
+    auto* view = priv->cpp->settingsView(MEDIA_SETTINGS_VIEW_NAME, active);
+    if (!view)
+        return;
+
+    if (active) {
+        media_settings_view_show_preview(MEDIA_SETTINGS_VIEW(view), TRUE);
+        gtk_stack_set_visible_child(GTK_STACK(priv->stack_main_view), view);
+        priv->last_settings_view = view;
     } else {
-        media_settings_view_show_preview(MEDIA_SETTINGS_VIEW(priv->media_settings_view), FALSE);
+        media_settings_view_show_preview(MEDIA_SETTINGS_VIEW(view), FALSE);
     }
 }
 
@@ -723,12 +855,17 @@ on_show_new_account_settings(GtkToggleButton* navbutton, MainWindow* self)
     g_return_if_fail(IS_MAIN_WINDOW(self));
     auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
 
-    if (gtk_toggle_button_get_active(navbutton)) {
-        new_account_settings_view_show(NEW_ACCOUNT_SETTINGS_VIEW(priv->new_account_settings_view), TRUE);
-        gtk_stack_set_visible_child_name(GTK_STACK(priv->stack_main_view), NEW_ACCOUNT_SETTINGS_VIEW_NAME);
-        priv->last_settings_view = priv->new_account_settings_view;
+    auto active = gtk_toggle_button_get_active(navbutton);
+    auto* view = priv->cpp->settingsView(NEW_ACCOUNT_SETTINGS_VIEW_NAME, active);
+    if (!view)
+        return;
+
+    if (active) {
+        new_account_settings_view_show(NEW_ACCOUNT_SETTINGS_VIEW(view), TRUE);
+        gtk_stack_set_visible_child(GTK_STACK(priv->stack_main_view), view);
+        priv->last_settings_view = view;
     } else {
-        new_account_settings_view_show(NEW_ACCOUNT_SETTINGS_VIEW(priv->new_account_settings_view), FALSE);
+        new_account_settings_view_show(NEW_ACCOUNT_SETTINGS_VIEW(view), FALSE);
     }
 }
 
@@ -739,8 +876,9 @@ on_show_general_settings(GtkToggleButton* navbutton, MainWindow* self)
     auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
 
     if (gtk_toggle_button_get_active(navbutton)) {
-        gtk_stack_set_visible_child_name(GTK_STACK(priv->stack_main_view), GENERAL_SETTINGS_VIEW_NAME);
-        priv->last_settings_view = priv->general_settings_view;
+        auto* view = priv->cpp->settingsView(GENERAL_SETTINGS_VIEW_NAME);
+        gtk_stack_set_visible_child(GTK_STACK(priv->stack_main_view), view);
+        priv->last_settings_view = view;
     }
 }
 
@@ -750,12 +888,17 @@ on_show_plugin_settings(GtkToggleButton* navbutton, MainWindow* self)
     g_return_if_fail(IS_MAIN_WINDOW(self));
     auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
 
-    if (gtk_toggle_button_get_active(navbutton)) {
-        plugin_settings_view_show(PLUGIN_SETTINGS_VIEW(priv->plugin_settings_view), TRUE);
-        gtk_stack_set_visible_child_name(GTK_STACK(priv->stack_main_view), PLUGIN_SETTINGS_VIEW_NAME);
-        priv->last_settings_view = priv->plugin_settings_view;
+    auto active = gtk_toggle_button_get_active(navbutton);
+    auto* view = priv->cpp->settingsView(PLUGIN_SETTINGS_VIEW_NAME, active);
+    if (!view)
+        return;
+
+    if (active) {
+        plugin_settings_view_show(PLUGIN_SETTINGS_VIEW(view), TRUE);
+        gtk_stack_set_visible_child(GTK_STACK(priv->stack_main_view), view);
+        priv->last_settings_view = view;
     } else {
-        plugin_settings_view_show(PLUGIN_SETTINGS_VIEW(priv->plugin_settings_view), FALSE);
+        plugin_settings_view_show(PLUGIN_SETTINGS_VIEW(view), FALSE);
     }
 }
 
@@ -768,6 +911,35 @@ on_search_entry_text_changed(GtkSearchEntry* search_entry, MainWindow* self)
     // Filter model
     const gchar *text = gtk_entry_get_text(GTK_ENTRY(search_entry));
     priv->cpp->accountInfo_->conversationModel->setFilter(text);
+
+    // Search messages of the account
+    std::vector<MessageIndexStore::Hit> results;
+    if (g_utf8_strlen(text, -1) >= MESSAGE_SEARCH_MIN_LENGTH)
+        results = MessageIndexStore::forAccount(priv->cpp->accountInfo_->id.toStdString())
+                      .search(text, MESSAGE_SEARCH_MAX_RESULTS);
+    conversations_view_set_message_results(CONVERSATIONS_VIEW(priv->treeview_conversations),
+                                           text, std::move(results));
+}
+
+static void
+on_message_result_selected(G_GNUC_UNUSED ConversationsView* view,
+                           const gchar* convUid,
+                           const gchar* interactionId,
+                           MainWindow* self)
+{
+    g_return_if_fail(IS_MAIN_WINDOW(self));
+    auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
+
+    // the conversation was just selected, scroll its chat to the message
+    auto* current_view = gtk_bin_get_child(GTK_BIN(priv->frame_call));
+    GtkWidget* chat_view = nullptr;
+    if (IS_CHAT_VIEW(current_view))
+        chat_view = current_view;
+    else if (IS_CURRENT_CALL_VIEW(current_view))
+        chat_view = current_call_view_get_chat_view(CURRENT_CALL_VIEW(current_view));
+    if (!chat_view || chat_view_get_conversation(CHAT_VIEW(chat_view)).uid != convUid)
+        return;
+    chat_view_show_interaction(CHAT_VIEW(chat_view), interactionId);
 }
 
 static void
@@ -795,6 +967,7 @@ on_search_entry_key_released(G_GNUC_UNUSED GtkEntry* search_entry, GdkEventKey*
     // if esc key pressed, clear the regex (keep the text, the user might not want to actually delete it)
     if (key->keyval == GDK_KEY_Escape) {
         priv->cpp->accountInfo_->conversationModel->setFilter("");
+        conversations_view_set_message_results(CONVERSATIONS_VIEW(priv->treeview_conversations), "", {});
         return GDK_EVENT_STOP;
     }
 
@@ -891,7 +1064,7 @@ on_tab_changed(GtkNotebook* notebook, GtkWidget* page, guint page_num, MainWindo
     else if (priv->cpp->accountInfo_->profileInfo.type == lrc::api::profile::Type::SIP)
         newType = lrc::api::FilterType::SIP;
 
-    newType = page_num == 0 ? newType : lrc::api::FilterType::REQUEST;
+    newType = static_cast<int>(page_num) == priv->cpp->contactRequestsPageNum ? lrc::api::FilterType::REQUEST : newType;
     if (priv->cpp->currentFilterType_ != newType) {
         priv->cpp->currentFilterType_ = newType;
         priv->cpp->accountInfo_->conversationModel->setFilter(priv->cpp->currentFilterType_);
@@ -937,6 +1110,44 @@ on_search_entry_places_call_changed(GSettings* settings, const gchar* key, MainW
     }
 }
 
+static void
+on_unified_conversations_list_changed(GSettings* settings, const gchar* key, MainWindow* self)
+{
+    g_return_if_fail(IS_MAIN_WINDOW(self));
+    auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
+    priv->cpp->showUnifiedConversations(g_settings_get_boolean(settings, key));
+}
+
+static void
+on_call_telemetry_changed(G_GNUC_UNUSED GSettings* settings, G_GNUC_UNUSED const gchar* key, MainWindow* self)
+{
+    g_return_if_fail(IS_MAIN_WINDOW(self));
+    auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
+    priv->cpp->updateCallTelemetry();
+}
+
+static void
+on_unified_conversation_selected(G_GNUC_UNUSED UnifiedConversationsView* view,
+                                 gchar* accountId,
+                                 gchar* uid,
+                                 MainWindow* self)
+{
+    g_return_if_fail(IS_MAIN_WINDOW(self));
+    auto* priv = MAIN_WINDOW_GET_PRIVATE(MAIN_WINDOW(self));
+
+    if (priv->cpp->show_settings)
+        priv->cpp->leaveSettingsView();
+
+    // same as a click on a notification of another account
+    if (!priv->cpp->accountInfo_ || priv->cpp->accountInfo_->id.toStdString() != accountId) {
+        priv->cpp->updateLrc(accountId);
+        priv->cpp->refreshAccountSelectorWidget(-1, accountId);
+        priv->cpp->refreshPendingContactRequestTab();
+    }
+    if (priv->cpp->accountInfo_)
+        priv->cpp->accountInfo_->conversationModel->selectConversation(uid);
+}
+
 static void
 on_handle_account_migrations(MainWindow* self)
 {
@@ -1164,6 +1375,7 @@ CppImpl::CppImpl(MainWindow& widget)
     : self {&widget}
     , widgets {MAIN_WINDOW_GET_PRIVATE(&widget)}
 {
+    startup_tracer_begin("Lrc");
     lrc_ = std::make_unique<lrc::api::Lrc>([this](){
         widgets->migratingDialog_ = gtk_message_dialog_new(
             GTK_WINDOW(self), GTK_DIALOG_DESTROY_WITH_PARENT,
@@ -1201,6 +1413,7 @@ CppImpl::CppImpl(MainWindow& widget)
     [this](){
         gtk_widget_destroy(widgets->migratingDialog_);
     });
+    startup_tracer_end("Lrc");
 }
 
 static void
@@ -1294,6 +1507,7 @@ nm_client_cb(G_GNUC_UNUSED GObject *source_object, GAsyncResult *result,  MainWi
 void
 CppImpl::init()
 {
+    startup_tracer_begin("CppImpl::init");
     widgets->cancellable = g_cancellable_new();
 #if USE_LIBNM
      // monitor the network using libnm to notify the daemon about connectivity changes
@@ -1330,10 +1544,7 @@ CppImpl::init()
         updateLrc(accountIds.front().toStdString());
     } else {
         // No account: create empty widgets
-        widgets->treeview_conversations = conversations_view_new(accountInfo_);
-        gtk_container_add(GTK_CONTAINER(widgets->scrolled_window_smartview), widgets->treeview_conversations);
-        widgets->treeview_contact_requests = conversations_view_new(accountInfo_);
-        gtk_container_add(GTK_CONTAINER(widgets->scrolled_window_contact_requests), widgets->treeview_contact_requests);
+        attachConversationsViews("");
     }
 
     accountStatusChangedConnection_ = QObject::connect(&lrc_->getAccountModel(),
@@ -1370,6 +1581,18 @@ CppImpl::init()
     g_signal_connect(widgets->window_settings, "changed::search-entry-places-call",
                      G_CALLBACK(on_search_entry_places_call_changed), self);
 
+    /* unified-conversations-list setting */
+    on_unified_conversations_list_changed(widgets->window_settings, "unified-conversations-list", self);
+    g_signal_connect(widgets->window_settings, "changed::unified-conversations-list",
+                     G_CALLBACK(on_unified_conversations_list_changed), self);
+
+    /* record-call-telemetry and call-telemetry-size-limit settings */
+    updateCallTelemetry();
+    g_signal_connect(widgets->window_settings, "changed::record-call-telemetry",
+                     G_CALLBACK(on_call_telemetry_changed), self);
+    g_signal_connect(widgets->window_settings, "changed::call-telemetry-size-limit",
+                     G_CALLBACK(on_call_telemetry_changed), self);
+
     /* set window icon */
     GError *error = NULL;
     GdkPixbuf* icon = gdk_pixbuf_new_from_resource("/net/jami/JamiGnome/jami-symbol-blue", &error);
@@ -1406,39 +1629,44 @@ CppImpl::init()
     gtk_stack_add_named(GTK_STACK(widgets->stack_main_view), widgets->vbox_call_view,
                         CALL_VIEW_NAME);
 
-    widgets->media_settings_view = media_settings_view_new(lrc_->getAVModel());
-    gtk_stack_add_named(GTK_STACK(widgets->stack_main_view), widgets->media_settings_view,
-                        MEDIA_SETTINGS_VIEW_NAME);
-
-    widgets->plugin_settings_view = plugin_settings_view_new(lrc_->getPluginModel());
-    gtk_stack_add_named(GTK_STACK(widgets->stack_main_view), widgets->plugin_settings_view,
-                        PLUGIN_SETTINGS_VIEW_NAME);
-
-    if (not accountIds.empty()) {
-        widgets->new_account_settings_view = new_account_settings_view_new(accountInfo_, lrc_->getAVModel());
-        gtk_stack_add_named(GTK_STACK(widgets->stack_main_view), widgets->new_account_settings_view,
-                            NEW_ACCOUNT_SETTINGS_VIEW_NAME);
-    }
-
-    widgets->general_settings_view = general_settings_view_new(GTK_WIDGET(self), lrc_->getAVModel(), lrc_->getAccountModel());
-    widgets->update_download_folder = g_signal_connect_swapped(
-        widgets->general_settings_view,
-        "update-download-folder",
-        G_CALLBACK(update_download_folder),
-        self
-    );
-    gtk_stack_add_named(GTK_STACK(widgets->stack_main_view), widgets->general_settings_view,
-                        GENERAL_SETTINGS_VIEW_NAME);
-    g_signal_connect_swapped(widgets->general_settings_view, "clear-all-history", G_CALLBACK(on_clear_all_history_clicked), self);
-
+    /* The settings views parse big .ui files and query the daemon, most
+     * sessions never open them. They are built when first shown, see
+     * settingsView(), or once the window is drawn, see prebuildSettingsViews().
+     * Each factory also keeps the widget in MainWindowPrivate. */
+    settingsViewFactories_ = {
+        {NEW_ACCOUNT_SETTINGS_VIEW_NAME, [this]() -> GtkWidget* {
+            if (!accountInfo_)
+                return nullptr;
+            widgets->new_account_settings_view = new_account_settings_view_new(accountInfo_, lrc_->getAVModel());
+            return widgets->new_account_settings_view;
+        }},
+        {GENERAL_SETTINGS_VIEW_NAME, [this]() -> GtkWidget* {
+            widgets->general_settings_view = general_settings_view_new(GTK_WIDGET(self), lrc_->getAVModel(), lrc_->getAccountModel());
+            widgets->update_download_folder = g_signal_connect_swapped(
+                widgets->general_settings_view,
+                "update-download-folder",
+                G_CALLBACK(update_download_folder),
+                self
+            );
+            g_signal_connect_swapped(widgets->general_settings_view, "clear-all-history", G_CALLBACK(on_clear_all_history_clicked), self);
+            return widgets->general_settings_view;
+        }},
+        {MEDIA_SETTINGS_VIEW_NAME, [this]() -> GtkWidget* {
+            widgets->media_settings_view = media_settings_view_new(lrc_->getAVModel());
+            return widgets->media_settings_view;
+        }},
+        {PLUGIN_SETTINGS_VIEW_NAME, [this]() -> GtkWidget* {
+            widgets->plugin_settings_view = plugin_settings_view_new(lrc_->getPluginModel());
+            return widgets->plugin_settings_view;
+        }},
+    };
+    firstDrawHandler_ = g_signal_connect_after(self, "draw", G_CALLBACK(on_first_draw), nullptr);
 
     /* make the account settings will be showed as the active one (or general if no accounts) */
     if (not accountIds.empty()) {
         gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->radiobutton_new_account_settings), TRUE);
-        widgets->last_settings_view = widgets->new_account_settings_view;
     } else {
         gtk_toggle_button_set_active(GTK_TOGGLE_BUTTON(widgets->radiobutton_general_settings), TRUE);
-        widgets->last_settings_view = widgets->general_settings_view;
     }
 
     /* connect the settings button signals to switch settings views */
@@ -1519,14 +1747,11 @@ CppImpl::init()
             }
         }
     }
-    // delete obsolete history
-    if (not accountIds.empty()) {
-        auto days = g_settings_get_int(widgets->window_settings, "history-limit");
-        for (auto& accountId : accountIds) {
-            auto& accountInfo = lrc_->getAccountModel().getAccountInfo(accountId);
-            accountInfo.conversationModel->deleteObsoleteHistory(days);
-        }
-    }
+    // delete obsolete history, in the background once started
+    historyPruner_ = std::make_unique<HistoryPruner>(*lrc_);
+
+    // index messages of every account in the background
+    foreachLrcAccount(*lrc_, [this] (const auto& accountInfo) { attachMessageIndex(accountInfo); });
 
     // No account? Show wizard
     auto accounts = lrc_->getAccountModel().getAccountList();
@@ -1546,10 +1771,32 @@ CppImpl::init()
                                                   G_CALLBACK(on_notification_accept_call), self);
     widgets->notif_decline_call = g_signal_connect(widgets->notifier, "declineCall",
                                                    G_CALLBACK(on_notification_decline_call), self);
+    startup_tracer_end("CppImpl::init");
 }
 
 CppImpl::~CppImpl()
 {
+    if (firstDrawHandler_)
+        g_signal_handler_disconnect(self, firstDrawHandler_);
+    if (prebuildSettingsSource_)
+        g_source_remove(prebuildSettingsSource_);
+    if (accountSelectorRefreshSource_)
+        g_source_remove(accountSelectorRefreshSource_);
+    g_clear_object(&accountSelectorStore_);
+
+    for (auto& notification : chatNotifications_) {
+        if (notification.second.flushSource)
+            g_source_remove(notification.second.flushSource);
+    }
+
+    for (auto& views : conversationsViewsCache_)
+        views.destroyDetached();
+    conversationsViewsCache_.clear();
+    // it follows every account, drop it before LRC
+    if (unifiedConversationsPage_)
+        gtk_widget_destroy(unifiedConversationsPage_);
+    call_telemetry_disable();
+
     QObject::disconnect(showLeaveMessageViewConnection_);
     QObject::disconnect(showChatViewConnection_);
     QObject::disconnect(historyClearedConnection_);
@@ -1574,10 +1821,76 @@ CppImpl::~CppImpl()
     QObject::disconnect(accountStatusChangedConnection_);
     QObject::disconnect(profileUpdatedConnection_);
 
+    MessageIndexStore::releaseAll();
+
     g_clear_object(&widgets->welcome_view);
     g_clear_object(&widgets->webkit_chat_container);
 }
 
+GtkWidget*
+CppImpl::settingsView(const char* name, bool build)
+{
+    if (auto* view = gtk_stack_get_child_by_name(GTK_STACK(widgets->stack_main_view), name))
+        return view;
+    if (!build)
+        return nullptr;
+
+    auto factory = std::find_if(settingsViewFactories_.begin(), settingsViewFactories_.end(),
+                                [name] (const auto& factory) { return g_strcmp0(factory.first, name) == 0; });
+    if (factory == settingsViewFactories_.end())
+        return nullptr;
+    auto* view = factory->second();
+    if (view)
+        gtk_stack_add_named(GTK_STACK(widgets->stack_main_view), view, name);
+    return view;
+}
+
+static gboolean
+prebuild_next_settings_view(MainWindow* self)
+{
+    auto* priv = MAIN_WINDOW_GET_PRIVATE(self);
+    auto& cpp = *priv->cpp;
+    for (const auto& factory : cpp.settingsViewFactories_) {
+        if (!gtk_stack_get_child_by_name(GTK_STACK(priv->stack_main_view), factory.first)
+            && cpp.settingsView(factory.first)) {
+            // one view per iteration, to keep the main loop responsive
+            return G_SOURCE_CONTINUE;
+        }
+    }
+    cpp.prebuildSettingsSource_ = 0;
+    return G_SOURCE_REMOVE;
+}
+
+void
+CppImpl::prebuildSettingsViews()
+{
+    if (prebuildSettingsSource_)
+        return;
+    prebuildSettingsSource_ = g_idle_add_full(G_PRIORITY_LOW,
+                                              (GSourceFunc)prebuild_next_settings_view,
+                                              self,
+                                              nullptr);
+}
+
+void
+CppImpl::attachMessageIndex(const lrc::api::account::Info& accountInfo)
+{
+    auto limit = g_settings_get_int(widgets->window_settings, "message-index-limit");
+    MessageIndexStore::forAccount(accountInfo.id.toStdString())
+        .attach(*accountInfo.conversationModel, std::max(limit, 0));
+}
+
+void
+CppImpl::updateCallTelemetry()
+{
+    if (!g_settings_get_boolean(widgets->window_settings, "record-call-telemetry")) {
+        call_telemetry_disable();
+        return;
+    }
+    auto limit = g_settings_get_int(widgets->window_settings, "call-telemetry-size-limit");
+    call_telemetry_enable(*lrc_, static_cast<gint64>(std::max(limit, 1)) * 1024 * 1024);
+}
+
 void
 CppImpl::changeView(GType type, OptRef<lrc::api::conversation::Info> convOpt)
 {
@@ -1772,7 +2085,7 @@ CppImpl::refreshPendingContactRequestTab()
 
     auto hasPendingRequests = accountInfo_->conversationModel->hasPendingRequests();
     gtk_widget_set_visible(widgets->scrolled_window_contact_requests, hasPendingRequests);
-    gtk_notebook_set_show_tabs(GTK_NOTEBOOK(widgets->notebook_contacts), hasPendingRequests);
+    refreshNotebookTabs();
 
     // show conversation page if PendingRequests list is empty
     if (not hasPendingRequests) {
@@ -1782,6 +2095,38 @@ CppImpl::refreshPendingContactRequestTab()
     }
 }
 
+void
+CppImpl::refreshNotebookTabs()
+{
+    auto hasPendingRequests = accountInfo_ && accountInfo_->conversationModel->hasPendingRequests();
+    gtk_notebook_set_show_tabs(GTK_NOTEBOOK(widgets->notebook_contacts),
+                               hasPendingRequests || unifiedConversationsPage_);
+}
+
+void
+CppImpl::showUnifiedConversations(bool show)
+{
+    if (show == (unifiedConversationsPage_ != nullptr))
+        return;
+
+    if (show) {
+        unifiedConversations_ = unified_conversations_view_new(*lrc_);
+        g_signal_connect(unifiedConversations_, "conversation-selected",
+                         G_CALLBACK(on_unified_conversation_selected), self);
+        unifiedConversationsPage_ = gtk_scrolled_window_new(nullptr, nullptr);
+        gtk_container_add(GTK_CONTAINER(unifiedConversationsPage_), unifiedConversations_);
+        gtk_widget_show_all(unifiedConversationsPage_);
+        gtk_notebook_append_page(GTK_NOTEBOOK(widgets->notebook_contacts),
+                                 unifiedConversationsPage_,
+                                 gtk_label_new(_("All accounts")));
+    } else {
+        gtk_widget_destroy(unifiedConversationsPage_);
+        unifiedConversationsPage_ = nullptr;
+        unifiedConversations_ = nullptr;
+    }
+    refreshNotebookTabs();
+}
+
 void
 CppImpl::showAccountSelectorWidget(bool show)
 {
@@ -1795,70 +2140,131 @@ CppImpl::showAccountSelectorWidget(bool show)
 std::size_t
 CppImpl::refreshAccountSelectorWidget(int selection_row, const std::string& selected)
 {
-    auto store = gtk_list_store_new(6 /* # of cols */ ,
-                                    G_TYPE_STRING,
-                                    G_TYPE_STRING,
-                                    G_TYPE_STRING,
-                                    G_TYPE_STRING,
-                                    G_TYPE_STRING,
-                                    G_TYPE_STRING,
-                                    G_TYPE_UINT);
+    if (accountSelectorRefreshSource_) {
+        g_source_remove(accountSelectorRefreshSource_);
+        accountSelectorRefreshSource_ = 0;
+    }
+
+    auto* comboBox = GTK_COMBO_BOX(widgets->combobox_account_selector);
+    if (!accountSelectorStore_) {
+        // the avatar is only a hash of it, the icon comes from accountIcon()
+        accountSelectorStore_ = gtk_list_store_new(6 /* # of cols */ ,
+                                                   G_TYPE_STRING,
+                                                   G_TYPE_STRING,
+                                                   G_TYPE_UINT64,
+                                                   G_TYPE_STRING,
+                                                   G_TYPE_STRING,
+                                                   G_TYPE_STRING);
+        gtk_combo_box_set_model(comboBox, GTK_TREE_MODEL(accountSelectorStore_));
+    }
+    auto* model = GTK_TREE_MODEL(accountSelectorStore_);
+
+    // the rows are updated in place while the accounts, and their order, are
+    // the same. Otherwise they are rebuilt, which selects the account again.
+    auto accountIds = lrc_->getAccountModel().getAccountList();
+    auto inPlace = static_cast<std::size_t>(gtk_tree_model_iter_n_children(model, nullptr)) == accountIds.size() + 1;
     GtkTreeIter iter;
+    auto valid = gtk_tree_model_get_iter_first(model, &iter);
+    for (const auto& accountId : accountIds) {
+        if (!inPlace || !valid)
+            break;
+        gchar* id;
+        gtk_tree_model_get(model, &iter, 0 /* col# */, &id /* data */, -1);
+        inPlace = g_strcmp0(qUtf8Printable(accountId), id) == 0;
+        g_free(id);
+        valid = gtk_tree_model_iter_next(model, &iter);
+    }
+    if (!inPlace)
+        gtk_list_store_clear(accountSelectorStore_);
+
     std::size_t enabled_accounts = 0;
     std::size_t idx = 0;
+    valid = gtk_tree_model_get_iter_first(model, &iter);
     foreachLrcAccount(*lrc_, [&] (const auto& acc_info) {
             ++enabled_accounts;
             if (!selected.empty() && selected == acc_info.id.toStdString()) {
                 selection_row = idx;
             }
-            gtk_list_store_append(store, &iter);
-            std::string status = "";
-            switch (acc_info.status) {
-                case lrc::api::account::Status::ERROR_NEED_MIGRATION:
-                    status = "NEEDS MIGRATION";
-                    break;
-                case lrc::api::account::Status::INVALID:
-                case lrc::api::account::Status::UNREGISTERED:
-                    status = "DISCONNECTED";
-                    break;
-                case lrc::api::account::Status::INITIALIZING:
-                case lrc::api::account::Status::TRYING:
-                    status = "TRYING";
-                    break;
-                case lrc::api::account::Status::REGISTERED:
-                    status = "CONNECTED";
-                    break;
-            }
-            gtk_list_store_set(store, &iter,
-                               0 /* col # */ , qUtf8Printable(acc_info.id) /* celldata */,
-                               1 /* col # */ , status.c_str() /* celldata */,
-                               2 /* col # */ , qUtf8Printable(acc_info.profileInfo.avatar) /* celldata */,
-                               3 /* col # */ , qUtf8Printable(acc_info.profileInfo.uri) /* celldata */,
-                               4 /* col # */ , qUtf8Printable(acc_info.profileInfo.alias) /* celldata */,
-                               5 /* col # */ , qUtf8Printable(acc_info.registeredName) /* celldata */,
-                               -1 /* end */);
+            if (!inPlace)
+                gtk_list_store_append(accountSelectorStore_, &iter);
+            setAccountSelectorRow(&iter, acc_info);
+            if (inPlace)
+                gtk_tree_model_iter_next(model, &iter);
             ++idx;
         });
 
-    gtk_list_store_append(store, &iter);
-    gtk_list_store_set(store, &iter,
-                       0 /* col # */ , "" /* celldata */,
-                       1 /* col # */ , "" /* celldata */,
-                       2 /* col # */ , "" /* celldata */,
-                       3 /* col # */ , "" /* celldata */,
-                       4 /* col # */ , "" /* celldata */,
-                       5 /* col # */ , "" /* celldata */,
-                       -1 /* end */);
-
-    gtk_combo_box_set_model(
-        GTK_COMBO_BOX(widgets->combobox_account_selector),
-        GTK_TREE_MODEL(store)
-    );
-    gtk_combo_box_set_active(GTK_COMBO_BOX(widgets->combobox_account_selector), selection_row);
+    if (!inPlace) {
+        gtk_list_store_append(accountSelectorStore_, &iter);
+        gtk_list_store_set(accountSelectorStore_, &iter,
+                           0 /* col # */ , "" /* celldata */,
+                           1 /* col # */ , "" /* celldata */,
+                           2 /* col # */ , G_GUINT64_CONSTANT(0) /* celldata */,
+                           3 /* col # */ , "" /* celldata */,
+                           4 /* col # */ , "" /* celldata */,
+                           5 /* col # */ , "" /* celldata */,
+                           -1 /* end */);
+    }
+
+    if (gtk_combo_box_get_active(comboBox) != selection_row)
+        gtk_combo_box_set_active(comboBox, selection_row);
 
     return enabled_accounts;
 }
 
+void
+CppImpl::setAccountSelectorRow(GtkTreeIter* iter, const lrc::api::account::Info& accountInfo)
+{
+    auto* model = GTK_TREE_MODEL(accountSelectorStore_);
+    auto id = accountInfo.id.toUtf8();
+    auto* status = account_status_name(accountInfo.status);
+    guint64 avatar = std::hash<std::string>()(accountInfo.profileInfo.avatar.toStdString());
+    auto uri = accountInfo.profileInfo.uri.toUtf8();
+    auto alias = accountInfo.profileInfo.alias.toUtf8();
+    auto registeredName = accountInfo.registeredName.toUtf8();
+
+    // a row set again is drawn again, only set the ones which changed
+    gchar *oldId, *oldStatus, *oldUri, *oldAlias, *oldRegisteredName;
+    guint64 oldAvatar;
+    gtk_tree_model_get(model, iter,
+                       0 /* col# */, &oldId /* data */,
+                       1 /* col# */, &oldStatus /* data */,
+                       2 /* col# */, &oldAvatar /* data */,
+                       3 /* col# */, &oldUri /* data */,
+                       4 /* col# */, &oldAlias /* data */,
+                       5 /* col# */, &oldRegisteredName /* data */,
+                       -1);
+    auto changed = g_strcmp0(oldId, id.constData()) != 0
+        || g_strcmp0(oldStatus, status) != 0
+        || oldAvatar != avatar
+        || g_strcmp0(oldUri, uri.constData()) != 0
+        || g_strcmp0(oldAlias, alias.constData()) != 0
+        || g_strcmp0(oldRegisteredName, registeredName.constData()) != 0;
+    g_free(oldId);
+    g_free(oldStatus);
+    g_free(oldUri);
+    g_free(oldAlias);
+    g_free(oldRegisteredName);
+
+    if (changed) {
+        gtk_list_store_set(accountSelectorStore_, iter,
+                           0 /* col # */ , id.constData() /* celldata */,
+                           1 /* col # */ , status /* celldata */,
+                           2 /* col # */ , avatar /* celldata */,
+                           3 /* col # */ , uri.constData() /* celldata */,
+                           4 /* col # */ , alias.constData() /* celldata */,
+                           5 /* col # */ , registeredName.constData() /* celldata */,
+                           -1 /* end */);
+    }
+}
+
+void
+CppImpl::scheduleAccountSelectorRefresh()
+{
+    if (accountSelectorRefreshSource_)
+        g_source_remove(accountSelectorRefreshSource_);
+    accountSelectorRefreshSource_ = g_timeout_add(ACCOUNT_SELECTOR_REFRESH_MS, refresh_account_selector, this);
+}
+
 void
 CppImpl::enterAccountCreationWizard(bool showControls)
 {
@@ -1896,6 +2302,9 @@ CppImpl::leaveAccountCreationWizard()
     auto old_view = gtk_stack_get_visible_child(GTK_STACK(widgets->stack_main_view));
     if(IS_ACCOUNT_MIGRATION_VIEW(old_view)) return;
     if (show_settings) {
+        /* the settings views are built on demand, none may exist yet */
+        if (!widgets->last_settings_view)
+            widgets->last_settings_view = settingsView(GENERAL_SETTINGS_VIEW_NAME);
         gtk_stack_set_visible_child(GTK_STACK(widgets->stack_main_view), widgets->last_settings_view);
         gtk_widget_show(widgets->hbox_settings);
     } else {
@@ -1951,6 +2360,14 @@ CppImpl::enterSettingsView()
 
     gtk_widget_show(widgets->hbox_settings);
 
+    /* first time, show the view selected by default */
+    if (!widgets->last_settings_view) {
+        if (gtk_toggle_button_get_active(GTK_TOGGLE_BUTTON(widgets->radiobutton_new_account_settings)))
+            widgets->last_settings_view = settingsView(NEW_ACCOUNT_SETTINGS_VIEW_NAME);
+        if (!widgets->last_settings_view)
+            widgets->last_settings_view = settingsView(GENERAL_SETTINGS_VIEW_NAME);
+    }
+
     /* make sure to start preview if we're showing the video settings */
     if (widgets->last_settings_view == widgets->media_settings_view)
         media_settings_view_show_preview(MEDIA_SETTINGS_VIEW(widgets->media_settings_view), TRUE);
@@ -1980,10 +2397,13 @@ CppImpl::leaveSettingsView()
     gtk_widget_hide(widgets->hbox_settings);
 
     /* make sure video preview is stopped, in case it was started */
-    media_settings_view_show_preview(MEDIA_SETTINGS_VIEW(widgets->media_settings_view), FALSE);
-    new_account_settings_view_show(NEW_ACCOUNT_SETTINGS_VIEW(widgets->new_account_settings_view),
-                                   FALSE);
-    plugin_settings_view_show(PLUGIN_SETTINGS_VIEW(widgets->plugin_settings_view), FALSE);
+    if (widgets->media_settings_view)
+        media_settings_view_show_preview(MEDIA_SETTINGS_VIEW(widgets->media_settings_view), FALSE);
+    if (widgets->new_account_settings_view)
+        new_account_settings_view_show(NEW_ACCOUNT_SETTINGS_VIEW(widgets->new_account_settings_view),
+                                       FALSE);
+    if (widgets->plugin_settings_view)
+        plugin_settings_view_show(PLUGIN_SETTINGS_VIEW(widgets->plugin_settings_view), FALSE);
 
     gtk_stack_set_visible_child_name(GTK_STACK(widgets->stack_main_view), CALL_VIEW_NAME);
 
@@ -2053,6 +2473,98 @@ CppImpl::showOkCancelDialog(const std::string &title, const std::string &text)
     return res == GTK_RESPONSE_OK;
 }
 
+void
+CppImpl::detachConversationsViews(const std::string& accountIdToFlagFreeable)
+{
+    auto& current = conversationsViews_;
+    if (current.conversations) {
+        for (auto* view : {current.conversations, current.contactRequests}) {
+            auto selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(view));
+            gtk_tree_selection_unselect_all(GTK_TREE_SELECTION(selection));
+        }
+
+        if (current.accountId.empty() || current.accountId == accountIdToFlagFreeable) {
+            gtk_widget_destroy(current.conversations);
+            gtk_widget_destroy(current.contactRequests);
+        } else {
+            // keep the views, they are updated in background until shown again
+            for (auto* view : {current.conversations, current.contactRequests}) {
+                g_object_ref(view);
+                gtk_container_remove(GTK_CONTAINER(gtk_widget_get_parent(view)), view);
+                conversations_view_set_active(CONVERSATIONS_VIEW(view), false);
+            }
+            conversationsViewsCache_.emplace_front(std::move(current));
+        }
+        current = {};
+        widgets->treeview_conversations = nullptr;
+        widgets->treeview_contact_requests = nullptr;
+    }
+
+    if (!accountIdToFlagFreeable.empty()) {
+        // the account info of the removed account is about to be freed
+        for (auto it = conversationsViewsCache_.begin(); it != conversationsViewsCache_.end();) {
+            if (it->accountId != accountIdToFlagFreeable) {
+                ++it;
+                continue;
+            }
+            it->destroyDetached();
+            it = conversationsViewsCache_.erase(it);
+        }
+    }
+
+    trimConversationsViewsCache();
+}
+
+void
+CppImpl::attachConversationsViews(const std::string& accountId)
+{
+    auto& current = conversationsViews_;
+    auto cached = std::find_if(conversationsViewsCache_.begin(), conversationsViewsCache_.end(),
+                               [&accountId] (const ConversationsViews& views) {
+                                   return views.accountId == accountId;
+                               });
+    if (!accountId.empty() && cached != conversationsViewsCache_.end()) {
+        current = std::move(*cached);
+        conversationsViewsCache_.erase(cached);
+        gtk_container_add(GTK_CONTAINER(widgets->scrolled_window_smartview), current.conversations);
+        gtk_container_add(GTK_CONTAINER(widgets->scrolled_window_contact_requests), current.contactRequests);
+        for (auto* view : {current.conversations, current.contactRequests}) {
+            g_object_unref(view);
+            conversations_view_set_active(CONVERSATIONS_VIEW(view), true);
+        }
+    } else {
+        current.accountId = accountId;
+        current.accountInfo = std::make_unique<AccountInfoPointer>(accountInfo_);
+        current.conversations = conversations_view_new(*current.accountInfo);
+        gtk_container_add(GTK_CONTAINER(widgets->scrolled_window_smartview), current.conversations);
+        g_signal_connect(current.conversations, "message-result-selected",
+                         G_CALLBACK(on_message_result_selected), self);
+        current.contactRequests = conversations_view_new(*current.accountInfo);
+        gtk_container_add(GTK_CONTAINER(widgets->scrolled_window_contact_requests), current.contactRequests);
+    }
+    widgets->treeview_conversations = current.conversations;
+    widgets->treeview_contact_requests = current.contactRequests;
+}
+
+void
+CppImpl::trimConversationsViewsCache()
+{
+    gint rows = 0;
+    for (const auto& views : conversationsViewsCache_)
+        rows += views.rows();
+
+    while (!conversationsViewsCache_.empty()
+           && (conversationsViewsCache_.size() > MAX_CACHED_CONVERSATIONS_VIEWS
+               || rows > MAX_CACHED_CONVERSATIONS_ROWS)) {
+        auto& oldest = conversationsViewsCache_.back();
+        rows -= oldest.rows();
+        g_debug("dropping the conversation lists of %s, %d rows cached",
+                oldest.accountId.c_str(), rows);
+        oldest.destroyDetached();
+        conversationsViewsCache_.pop_back();
+    }
+}
+
 void
 CppImpl::updateLrc(const std::string& id, const std::string& accountIdToFlagFreeable)
 {
@@ -2092,22 +2604,9 @@ CppImpl::updateLrc(const std::string& id, const std::string& accountIdToFlagFree
     else
         accountInfo_ = nullptr;
 
-    // Reinit tree views
-    if (widgets->treeview_conversations) {
-        auto selection_conversations = gtk_tree_view_get_selection(GTK_TREE_VIEW(widgets->treeview_conversations));
-        gtk_tree_selection_unselect_all(GTK_TREE_SELECTION(selection_conversations));
-        gtk_widget_destroy(widgets->treeview_conversations);
-    }
-    widgets->treeview_conversations = conversations_view_new(accountInfo_);
-    gtk_container_add(GTK_CONTAINER(widgets->scrolled_window_smartview), widgets->treeview_conversations);
-
-    if (widgets->treeview_contact_requests) {
-        auto selection_conversations = gtk_tree_view_get_selection(GTK_TREE_VIEW(widgets->treeview_contact_requests));
-        gtk_tree_selection_unselect_all(GTK_TREE_SELECTION(selection_conversations));
-        gtk_widget_destroy(widgets->treeview_contact_requests);
-    }
-    widgets->treeview_contact_requests = conversations_view_new(accountInfo_);
-    gtk_container_add(GTK_CONTAINER(widgets->scrolled_window_contact_requests), widgets->treeview_contact_requests);
+    // Swap the tree views
+    detachConversationsViews(accountIdToFlagFreeable);
+    attachConversationsViews(id);
 
     if (!accountInfo_) return;
 
@@ -2225,11 +2724,7 @@ CppImpl::slotAccountAddedFromLrc(const std::string& id)
             updateLrc(id);
             welcome_update_view(WELCOME_VIEW(widgets->welcome_view));
         }
-        if (!gtk_stack_get_child_by_name(GTK_STACK(widgets->stack_main_view), NEW_ACCOUNT_SETTINGS_VIEW_NAME)) {
-            widgets->new_account_settings_view = new_account_settings_view_new(accountInfo_, lrc_->getAVModel());
-            gtk_stack_add_named(GTK_STACK(widgets->stack_main_view), widgets->new_account_settings_view,
-                                NEW_ACCOUNT_SETTINGS_VIEW_NAME);
-        }
+        attachMessageIndex(account_info);
         refreshAccountSelectorWidget(currentIdx, id);
         if (account_info.profileInfo.type == lrc::api::profile::Type::SIP) {
             enterSettingsView();
@@ -2245,6 +2740,9 @@ CppImpl::slotAccountRemovedFromLrc(const std::string& id)
 {
     /* Before doing anything, we need to update the struct pointers
        and tell the LRC it can free the old structures. */
+    MessageIndexStore::release(id);
+    accountIcons_.erase(id);
+    avatar_cache_invalidate(id);
     updateLrc("", id);
 
     auto accounts = lrc_->getAccountModel().getAccountList();
@@ -2318,12 +2816,10 @@ CppImpl::slotAccountStatusChanged(const std::string& id)
         return;
     }
 
-    new_account_settings_view_update(NEW_ACCOUNT_SETTINGS_VIEW(widgets->new_account_settings_view), false);
-    auto currentIdx = gtk_combo_box_get_active(GTK_COMBO_BOX(widgets->combobox_account_selector));
-    if (currentIdx == -1)
-        currentIdx = 0; // If no account selected, select the first account
-    // NOTE: Because the currentIdx can change (accounts can be re-ordered), force to select the accountInfo_->id
-    refreshAccountSelectorWidget(currentIdx, accountInfo_->id.toStdString());
+    if (widgets->new_account_settings_view)
+        new_account_settings_view_update(NEW_ACCOUNT_SETTINGS_VIEW(widgets->new_account_settings_view), false);
+    // the row of the account is updated once the status settled
+    scheduleAccountSelectorRefresh();
 
     if (accountInfo_->status == lrc::api::account::Status::ERROR_NEED_MIGRATION) {
         slotAccountNeedsMigration(id);
@@ -2405,7 +2901,7 @@ CppImpl::slotCallStatusChanged(const std::string& accountId, const std::string&
                 show_notification(NOTIFIER(widgets->notifier),
                                 avatar.toStdString(), uri.toStdString(), name.toStdString(),
                                 accountId + ":interaction:" + conversation + ":0",
-                                _("Missed call"), body, NotificationType::CHAT);
+                                _("Missed call"), body, NotificationType::CHAT, conversation);
             }
         }
     } catch (const std::exception& e) {
@@ -2678,9 +3174,37 @@ CppImpl::slotCloseTrustRequest(const std::string& id, const std::string& contact
     }
 }
 
+struct ChatNotificationRef
+{
+    CppImpl* cpp;
+    std::string notifId;
+};
+
+static gboolean
+flush_chat_notification(gpointer data)
+{
+    auto* ref = static_cast<ChatNotificationRef*>(data);
+    auto it = ref->cpp->chatNotifications_.find(ref->notifId);
+    if (it == ref->cpp->chatNotifications_.end())
+        return G_SOURCE_REMOVE;
+    if (!it->second.changed) {
+        // quiet for a whole window, the next message starts a new burst
+        it->second.flushSource = 0;
+        return G_SOURCE_REMOVE;
+    }
+    ref->cpp->showChatNotification(ref->notifId);
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+free_chat_notification_ref(gpointer data)
+{
+    delete static_cast<ChatNotificationRef*>(data);
+}
+
 void
 CppImpl::slotNewInteraction(const std::string& accountId, const std::string& conversation,
-                            const QString& interactionId, const lrc::api::interaction::Info& interaction)
+                            const QString& /*interactionId*/, const lrc::api::interaction::Info& interaction)
 {
     if (chatViewConversation_
         && chatViewConversation_->get().uid == QString::fromStdString(conversation)
@@ -2693,72 +3217,146 @@ CppImpl::slotNewInteraction(const std::string& accountId, const std::string& con
             return;
         }
     }
-    try {
-        auto& accountInfo = lrc_->getAccountModel().getAccountInfo(QString::fromStdString(accountId));
-        auto notifId = accountInfo.id.toStdString() + ":interaction:" + conversation + ":" + interactionId.toStdString();
-        auto& contactModel = accountInfo.contactModel;
-        auto& conversationModel = accountInfo.conversationModel;
-        for (lrc::api::conversation::Info& conv : conversationModel->allFilteredConversations().get())
-        {
-            if (conv.uid.toStdString() == conversation) {
-                if (conv.participants.empty()) return;
-                QString avatar = "", name = "", uri = "";
-
-                auto contacts = conversationModel->peersForConversation(conv.uid);
-                if (contacts.empty()) return;
-
-                try {
-                    auto contactInfo = contactModel->getContact(contacts.front());
-                    uri = contactInfo.profileInfo.uri;
-                    avatar = contactInfo.profileInfo.avatar;
-                    name = contactInfo.profileInfo.alias;
+    // one notification per conversation, updated by the next messages
+    auto notifId = accountId + ":interaction:" + conversation;
+    auto it = chatNotifications_.find(notifId);
+    if (it == chatNotifications_.end() || !it->second.flushSource) {
+        // first message of a burst, (re)load the contact
+        try {
+            auto& accountInfo = lrc_->getAccountModel().getAccountInfo(QString::fromStdString(accountId));
+            auto& conversationModel = accountInfo.conversationModel;
+            auto convOpt = conversationModel->getConversationForUid(QString::fromStdString(conversation));
+            if (!convOpt || convOpt->get().participants.empty()) return;
+            auto contacts = conversationModel->peersForConversation(convOpt->get().uid);
+            if (contacts.empty()) return;
+
+            ChatNotification entry;
+            entry.conversation = conversation;
+            try {
+                auto contactInfo = accountInfo.contactModel->getContact(contacts.front());
+                auto name = contactInfo.profileInfo.alias;
+                if (name.isEmpty()) {
+                    name = contactInfo.registeredName;
                     if (name.isEmpty()) {
-                        name = contactInfo.registeredName;
-                        if (name.isEmpty()) {
-                            name = contactInfo.profileInfo.uri;
-                        }
+                        name = contactInfo.profileInfo.uri;
                     }
-                } catch (...) {
-                    g_warning("Can't get contact for account %s. Don't show notification", qUtf8Printable(accountInfo.id));
-                    return;
-                }
-
-                if (g_settings_get_boolean(widgets->window_settings, "enable-chat-notifications")) {
-                    name.remove('\r');
-                    auto body = name + ": " + interaction.body;
-                    show_notification(NOTIFIER(widgets->notifier),
-                                      avatar.toStdString(), uri.toStdString(), name.toStdString(),
-                                      notifId, _("New message"), body.toStdString(), NotificationType::CHAT);
                 }
+                name.remove('\r');
+                entry.uri = contactInfo.profileInfo.uri.toStdString();
+                entry.avatar = contactInfo.profileInfo.avatar.toStdString();
+                entry.name = name.toStdString();
+            } catch (...) {
+                g_warning("Can't get contact for account %s. Don't show notification", qUtf8Printable(accountInfo.id));
+                return;
+            }
 
-                updateUrgency();
+            if (it == chatNotifications_.end()) {
+                it = chatNotifications_.emplace(notifId, std::move(entry)).first;
+            } else {
+                entry.count = it->second.count;
+                it->second = std::move(entry);
             }
+        } catch (...) {
+            g_warning("Can't get account %s", accountId.c_str());
+            return;
         }
-    } catch (...) {
-        g_warning("Can't get account %s", accountId.c_str());
     }
+
+    auto& entry = it->second;
+    ++entry.count;
+    entry.lastBody = interaction.body;
+    if (!entry.flushSource) {
+        showChatNotification(notifId);
+        auto window = g_settings_get_int(widgets->window_settings, "chat-notifications-window");
+        if (window > 0) {
+            // the next messages of the window are shown at most once, when it ends
+            entry.flushSource = g_timeout_add_full(G_PRIORITY_DEFAULT, window,
+                                                   flush_chat_notification,
+                                                   new ChatNotificationRef {this, notifId},
+                                                   free_chat_notification_ref);
+        }
+    } else {
+        entry.changed = true;
+    }
+
+    updateUrgency();
 }
 
 void
-CppImpl::slotCloseInteraction(const std::string& accountId, const std::string& conversation, const QString& interactionId)
+CppImpl::showChatNotification(const std::string& notifId)
+{
+    auto it = chatNotifications_.find(notifId);
+    if (it == chatNotifications_.end())
+        return;
+    auto& entry = it->second;
+    entry.changed = false;
+    if (!g_settings_get_boolean(widgets->window_settings, "enable-chat-notifications"))
+        return;
+
+    auto body = QString::fromStdString(entry.name) + ": " + entry.lastBody;
+    gchar* title = entry.count > 1
+        ? g_strdup_printf(ngettext("%u new message", "%u new messages", entry.count), entry.count)
+        : g_strdup(_("New message"));
+    show_notification(NOTIFIER(widgets->notifier),
+                      entry.avatar, entry.uri, entry.name,
+                      notifId, title, body.toStdString(), NotificationType::CHAT,
+                      entry.conversation);
+    g_free(title);
+}
+
+void
+CppImpl::slotCloseInteraction(const std::string& accountId, const std::string& conversation, const QString& /*interactionId*/)
 {
     if (!gtk_window_is_active(GTK_WINDOW(self))
         || (chatViewConversation_ && chatViewConversation_->get().uid != QString::fromStdString(conversation))) {
             return;
     }
-    try {
-        auto& accountInfo = lrc_->getAccountModel().getAccountInfo(QString::fromStdString(accountId));
-        auto notifId = accountInfo.id.toStdString() + ":interaction:" + conversation + ":" + interactionId.toStdString();
-        hide_notification(NOTIFIER(widgets->notifier), notifId);
-    } catch (...) {
-        g_warning("Can't get account %s", accountId.c_str());
+    // the conversation is read, drop its notifications and its count
+    auto notifId = accountId + ":interaction:" + conversation;
+    hide_conversation_notifications(NOTIFIER(widgets->notifier), conversation);
+    auto it = chatNotifications_.find(notifId);
+    if (it != chatNotifications_.end()) {
+        if (it->second.flushSource)
+            g_source_remove(it->second.flushSource);
+        chatNotifications_.erase(it);
     }
     updateUrgency();
 }
 
+GdkPixbuf*
+CppImpl::accountIcon(const std::string& id, const gchar* status, guint64 avatar)
+{
+    std::string statusStr = status ? status : "";
+    auto it = accountIcons_.find(id);
+    if (it != accountIcons_.end()
+        && it->second.status == statusStr
+        && it->second.avatar == avatar)
+        return it->second.pixbuf.get();
+
+    IconStatus iconStatus = IconStatus::INVALID;
+    if (g_strcmp0(status, "DISCONNECTED") == 0) {
+        iconStatus = IconStatus::DISCONNECTED;
+    } else if (g_strcmp0(status, "TRYING") == 0) {
+        iconStatus = IconStatus::TRYING;
+    } else if (g_strcmp0(status, "CONNECTED") == 0) {
+        iconStatus = IconStatus::CONNECTED;
+    }
+    std::string photo;
+    try {
+        photo = lrc_->getAccountModel().getAccountInfo(QString::fromStdString(id)).profileInfo.avatar.toStdString();
+    } catch (const std::out_of_range&) {
+        // removed meanwhile, the generated avatar is drawn
+    }
+    std::shared_ptr<GdkPixbuf> icon(avatar_cache_get(id, "", "", photo, QSize(32, 32), true, iconStatus),
+                                    g_object_unref);
+    accountIcons_[id] = {statusStr, avatar, icon};
+    return icon.get();
+}
+
 void
 CppImpl::slotProfileUpdated(const std::string& id)
 {
+    avatar_cache_invalidate(id);
     auto currentIdx = gtk_combo_box_get_active(GTK_COMBO_BOX(widgets->combobox_account_selector));
     if (currentIdx == -1)
         currentIdx = 0; // If no account selected, select the first account
@@ -3046,7 +3644,7 @@ main_window_dispose(GObject *object)
     g_clear_object(&priv->nm_client);
 #endif
 
-    if (priv->update_download_folder) {
+    if (priv->general_settings_view && priv->update_download_folder) {
         g_signal_handler_disconnect(priv->general_settings_view, priv->update_download_folder);
         priv->update_download_folder = 0;
     }
@@ -27,6 +27,7 @@
 #include <api/avmodel.h>
 #include <api/newvideo.h>
 
+#include "video/camerapreview.h"
 #include "video/video_widget.h"
 
 namespace { namespace details
@@ -71,11 +72,9 @@ struct _MediaSettingsViewPrivate
     GtkWidget *video_resolution_row;
     GtkWidget *video_framerate_row;
 
-    /* this is used to keep track of the state of the preview when the settings
-     * are opened; if a call is in progress, then the preview should already be
-     * started and we don't want to stop it when the settings are closed, in this
-     * case */
-    gboolean video_started_by_settings;
+    /* the preview shown while the settings are opened, shared with the calls
+     * and the other views showing it */
+    gchar* camera_preview;
 
     QMetaObject::Connection local_renderer_connection;
     QMetaObject::Connection device_event_connection;
@@ -389,8 +388,7 @@ CppImpl::drawVideoDevices()
         gtk_widget_hide(widgets->video_channel_row);
         gtk_widget_hide(widgets->video_resolution_row);
         gtk_widget_hide(widgets->video_framerate_row);
-        if (widgets->video_widget)
-            avModel_->stopPreview("camera://" + avModel_->getDefaultDevice());
+        camera_preview_release(&widgets->camera_preview);
         return;
     }
     if (gtk_widget_get_visible(widgets->no_camera_row)) {
@@ -401,7 +399,8 @@ CppImpl::drawVideoDevices()
         gtk_widget_show(widgets->video_resolution_row);
         gtk_widget_show(widgets->video_framerate_row);
         if (widgets->video_widget) {
-            avModel_->startPreview(avModel_->getDefaultDevice());
+            camera_preview_release(&widgets->camera_preview);
+            widgets->camera_preview = camera_preview_acquire(*avModel_);
         }
     }
 
@@ -444,10 +443,7 @@ media_settings_view_dispose(GObject *object)
     MediaSettingsViewPrivate *priv = MEDIA_SETTINGS_VIEW_GET_PRIVATE(view);
 
     /* make sure to stop the preview if this view is getting destroyed */
-    if (priv->video_started_by_settings) {
-        priv->cpp->avModel_->stopPreview("camera://" + priv->cpp->avModel_->getDefaultDevice());
-        priv->video_started_by_settings = FALSE;
-    }
+    camera_preview_release(&priv->camera_preview);
 
     QObject::disconnect(priv->local_renderer_connection);
     QObject::disconnect(priv->device_event_connection);
@@ -570,7 +566,10 @@ set_video_device(MediaSettingsView* self)
                 g_warning("set_video_device out_of_range exception");
             }
             priv->cpp->drawVideoDevices();
-            priv->cpp->avModel_->startPreview(priv->cpp->avModel_->getDefaultDevice());
+            if (priv->camera_preview) {
+                camera_preview_release(&priv->camera_preview);
+                priv->camera_preview = camera_preview_acquire(*priv->cpp->avModel_);
+            }
         }
         g_free(text);
     }
@@ -833,63 +832,54 @@ media_settings_view_show_preview(MediaSettingsView *self, gboolean show_preview)
         // set minimum size for video so it doesn't shrink too much
         gtk_widget_set_size_request(priv->video_widget, 400, -1);
 
-        try {
-            const lrc::api::video::Renderer* previewRenderer = video_widget_get_renderer(VIDEO_WIDGET(priv->video_widget), VIDEO_RENDERER_REMOTE);
-            priv->video_started_by_settings = previewRenderer && previewRenderer->isRendering();
-            if (priv->video_started_by_settings) {
-                video_widget_add_new_renderer(VIDEO_WIDGET(priv->video_widget),
-                    priv->cpp->avModel_, previewRenderer, VIDEO_RENDERER_REMOTE);
-            } else {
-                priv->video_started_by_settings = true;
-                priv->device_event_connection = QObject::connect(
-                    &*priv->cpp->avModel_,
-                    &lrc::api::AVModel::deviceEvent,
-                    [=]() {
-                        priv->cpp->drawAudioDevices();
-                        priv->cpp->drawVideoDevices();
-                    });
-                priv->local_renderer_connection = QObject::connect(
-                    &*priv->cpp->avModel_,
-                    &lrc::api::AVModel::rendererStarted,
-                    [=](const QString& id) {
-                        if (id.indexOf(priv->cpp->avModel_->getDefaultDevice()) == -1)
-                            return;
-                        const auto* prenderer = &priv->cpp->avModel_->getRenderer(id);
-                        video_widget_add_new_renderer(
-                            VIDEO_WIDGET(priv->video_widget),
-                            priv->cpp->avModel_,
-                            prenderer, VIDEO_RENDERER_REMOTE);
-                    });
-            }
-        } catch (const std::out_of_range& e) {
-            g_warning("Cannot start preview");
-        }
-
-        // check if the local render has already activated by others
+        // the preview may already be shown by a call or another view
         const lrc::api::video::Renderer* prenderer = nullptr;
         try {
             prenderer = &priv->cpp->avModel_->getRenderer(
                 "camera://" + priv->cpp->avModel_->getDefaultDevice());
         } catch (const std::out_of_range& e) {
         }
-        if (prenderer){
+        if (prenderer && prenderer->isRendering()) {
             video_widget_add_new_renderer(
                 VIDEO_WIDGET(priv->video_widget),
                 priv->cpp->avModel_,
                 prenderer, VIDEO_RENDERER_REMOTE);
         }
-        else
-            priv->cpp->avModel_->startPreview("camera://" + priv->cpp->avModel_->getDefaultDevice());
+
+        QObject::disconnect(priv->device_event_connection);
+        priv->device_event_connection = QObject::connect(
+            &*priv->cpp->avModel_,
+            &lrc::api::AVModel::deviceEvent,
+            [=]() {
+                priv->cpp->drawAudioDevices();
+                priv->cpp->drawVideoDevices();
+            });
+        QObject::disconnect(priv->local_renderer_connection);
+        priv->local_renderer_connection = QObject::connect(
+            &*priv->cpp->avModel_,
+            &lrc::api::AVModel::rendererStarted,
+            [=](const QString& id) {
+                if (id.indexOf(priv->cpp->avModel_->getDefaultDevice()) == -1)
+                    return;
+                try {
+                    const auto* prenderer = &priv->cpp->avModel_->getRenderer(id);
+                    video_widget_add_new_renderer(
+                        VIDEO_WIDGET(priv->video_widget),
+                        priv->cpp->avModel_,
+                        prenderer, VIDEO_RENDERER_REMOTE);
+                } catch (const std::out_of_range& e) {
+                    g_warning("Cannot start preview");
+                }
+            });
+        camera_preview_release(&priv->camera_preview);
+        priv->camera_preview = camera_preview_acquire(*priv->cpp->avModel_);
 
         priv->cpp->avModel_->startAudioDevice();
         priv->cpp->avModel_->setAudioMeterState(true);
     } else {
-        if (priv->video_started_by_settings) {
-            priv->cpp->avModel_->stopPreview("camera://" + priv->cpp->avModel_->getDefaultDevice());
-            QObject::disconnect(priv->local_renderer_connection);
-            QObject::disconnect(priv->device_event_connection);
-            priv->video_started_by_settings = FALSE;
-        }
+        camera_preview_release(&priv->camera_preview);
+        QObject::disconnect(priv->local_renderer_connection);
+        QObject::disconnect(priv->device_event_connection);
 
         if (priv->video_widget && IS_VIDEO_WIDGET(priv->video_widget))
             gtk_container_remove(GTK_CONTAINER(priv->preview_box), priv->video_widget);
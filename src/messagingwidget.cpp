@@ -34,6 +34,9 @@
 #include <api/account.h>
 #include <api/conversationmodel.h>
 
+// Jami Client
+#include "utils/styleregistry.h"
+
 namespace { namespace details
 {
 class CppImpl;
@@ -183,19 +186,7 @@ void
 CppImpl::init()
 {
     // CSS styles
-    auto provider = gtk_css_provider_new();
-    gtk_css_provider_load_from_data(provider,
-        ".flat-button { border: 0; border-radius: 50%; transition: all 0.3s ease; } \
-        .grey-button { background: #dfdfdf; } \
-        .grey-button:hover { background: #cecece; } \
-        .time-label { padding: 5px; } \
-        .timer-box { border: solid 2px; border-radius: 6px; }",
-        -1, nullptr
-    );
-
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/messagingwidget.css");
 
     // signals
     g_signal_connect_swapped(widgets->button_record_audio, "clicked", G_CALLBACK(on_record_button_pressed), self);
@@ -39,6 +39,7 @@
 #include "avatarmanipulation.h"
 #include "defines.h"
 #include "utils/files.h"
+#include "utils/styleregistry.h"
 #include "usernameregistrationbox.h"
 
 enum
@@ -1842,20 +1843,7 @@ build_settings_view(NewAccountSettingsView* view)
     auto* priv = NEW_ACCOUNT_SETTINGS_VIEW_GET_PRIVATE(view);
 
     // CSS styles
-    auto provider = gtk_css_provider_new();
-    std::string css = ".transparent-button { margin-left: 0; border: 0; background-color: rgba(0,0,0,0); margin-right: 0; padding-right: 0;}";
-    css += ".transparent-button:hover { border: 0; background-color: rgba(0,0,0,0);}";
-    css += ".show-button { padding: 0;}";
-    css += ".boxitem { padding: 12px; }";
-    css += ".green_label { color: white; background: #27ae60; border-radius: 3px; padding: 5px;}";
-    css += ".red_label { color: white; background: #dc3a37; border-radius: 3px; padding: 5px;}";
-    css += ".button_red { color: white; background: #dc3a37; border: 0; }";
-    css += ".button_red:hover { background: #dc2719; }";
-    css += ".larger { font-size: 300%; }";
-    gtk_css_provider_load_from_data(provider, css.c_str(), -1, nullptr);
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/newaccountsettingsview.css");
 
     priv->new_device_added_connection = QObject::connect(
         &*(*priv->accountInfo_)->deviceModel,
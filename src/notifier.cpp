@@ -27,18 +27,23 @@
 #endif // USE_CANBERRA
 
 #if USE_LIBNOTIFY
-#include "utils/drawing.h"
+#include "utils/avatarcache.h"
 #include <glib/gi18n.h>
 #include <libnotify/notify.h>
 #include <memory>
 #include <QSize>
 #include <QString>
-#include <map>
+#include <algorithm>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #endif
 
 
 static constexpr const char* SERVER_NOTIFY_OSD = "notify-osd";
 static constexpr const char* NOTIFICATION_FILE = SOUNDSDIR "/ringtone_notify.wav";
+// a burst of notifications plays the sound once
+static constexpr gint64 SOUND_INTERVAL_US = G_USEC_PER_SEC;
 
 namespace details
 {
@@ -70,8 +75,33 @@ G_DEFINE_TYPE_WITH_PRIVATE(Notifier, notifier, GTK_TYPE_BOX);
 struct Notification
 {
     std::shared_ptr<NotifyNotification> nn;
+    std::string id;
+    NotificationType type;
     std::string conversation;
+    // while it is tracked
+    details::CppImpl* owner = nullptr;
+    gulong closedHandler = 0;
+    // showing or closing a notification is a round trip to the notification
+    // server, it is done by a worker thread. The notification is left alone
+    // while it is busy there, what changes meanwhile is applied after.
+    bool busy = false;
+    bool reshow = false;
+    bool closed = false;
+    std::string title;
+    std::string body;
+    std::shared_ptr<GdkPixbuf> image;
 };
+
+struct NotificationJob
+{
+    GWeakRef view;
+    std::shared_ptr<Notification> notification;
+    bool close;
+    GError* error = nullptr;
+};
+
+static void run_notification_job(gpointer data, gpointer);
+static void on_notification_closed(NotifyNotification*, Notification* notification);
 #endif
 
 /* signals */
@@ -107,7 +137,20 @@ public:
     gboolean actions;
 
 #if USE_LIBNOTIFY
-    std::map<std::string, Notification> notifications_;
+    // keyed by a view of Notification::id, the id is only stored there
+    std::unordered_map<std::string_view, std::shared_ptr<Notification>> notifications_;
+    // the notifications of each conversation, alive as long as they are tracked
+    std::unordered_map<std::string, std::vector<Notification*>> conversations_;
+    GThreadPool* jobs_ = nullptr;
+
+    void track(const std::shared_ptr<Notification>& notification);
+    std::shared_ptr<Notification> forget(std::string_view id);
+    void index(Notification& notification);
+    void unindex(Notification& notification);
+#endif
+#if USE_CANBERRA
+    guint soundSource_ = 0;
+    gint64 lastSound_ = 0;
 #endif
 private:
     CppImpl() = delete;
@@ -118,10 +161,27 @@ private:
 CppImpl::CppImpl(Notifier& widget)
 : self {&widget}
 {
+#if USE_LIBNOTIFY
+    // a single thread, so the jobs of a notification run in order
+    jobs_ = g_thread_pool_new(run_notification_job, nullptr, 1, FALSE, nullptr);
+#endif
 }
 
 CppImpl::~CppImpl()
 {
+#if USE_LIBNOTIFY
+    for (const auto& notification : notifications_) {
+        if (notification.second->closedHandler)
+            g_signal_handler_disconnect(notification.second->nn.get(), notification.second->closedHandler);
+        notification.second->owner = nullptr;
+    }
+    // before notify_uninit(), the jobs queued are still run
+    g_thread_pool_free(jobs_, FALSE, TRUE);
+#endif
+#if USE_CANBERRA
+    if (soundSource_)
+        g_source_remove(soundSource_);
+#endif
     if (name)
         g_free(name);
     if (vendor)
@@ -132,6 +192,61 @@ CppImpl::~CppImpl()
         g_free(spec);
 }
 
+#if USE_LIBNOTIFY
+void
+CppImpl::track(const std::shared_ptr<Notification>& notification)
+{
+    notification->owner = this;
+    // the notifications of the calls stay until the call changes, which
+    // tells a missed call from the others
+    if (notification->type != NotificationType::CALL)
+        notification->closedHandler = g_signal_connect(notification->nn.get(), "closed",
+                                                       G_CALLBACK(on_notification_closed),
+                                                       notification.get());
+    notifications_.emplace(notification->id, notification);
+    index(*notification);
+}
+
+std::shared_ptr<Notification>
+CppImpl::forget(std::string_view id)
+{
+    auto it = notifications_.find(id);
+    if (it == notifications_.end())
+        return {};
+
+    auto notification = it->second;
+    notifications_.erase(it);
+    unindex(*notification);
+    if (notification->closedHandler) {
+        g_signal_handler_disconnect(notification->nn.get(), notification->closedHandler);
+        notification->closedHandler = 0;
+    }
+    notification->owner = nullptr;
+    return notification;
+}
+
+void
+CppImpl::index(Notification& notification)
+{
+    // same for the calls, they are hidden with the call
+    if (!notification.conversation.empty() && notification.type != NotificationType::CALL)
+        conversations_[notification.conversation].emplace_back(&notification);
+}
+
+void
+CppImpl::unindex(Notification& notification)
+{
+    auto it = conversations_.find(notification.conversation);
+    if (it == conversations_.end())
+        return;
+    auto& notifications = it->second;
+    notifications.erase(std::remove(notifications.begin(), notifications.end(), &notification),
+                        notifications.end());
+    if (notifications.empty())
+        conversations_.erase(it);
+}
+#endif
+
 } // namespace details
 
 static void
@@ -285,6 +400,119 @@ decline_call(NotifyNotification*, char* id, Notifier* view)
     g_signal_emit(G_OBJECT(view), notifier_signals[DECLINE_CALL], 0, newId.substr(std::string("decline:").length()).c_str());
 }
 
+static void
+apply_notification(Notification& notification)
+{
+    notify_notification_update(notification.nn.get(),
+                               notification.title.c_str(),
+                               notification.body.c_str(),
+                               nullptr);
+    notify_notification_set_image_from_pixbuf(notification.nn.get(), notification.image.get());
+}
+
+static void
+queue_notification_job(Notifier* view, const std::shared_ptr<Notification>& notification, bool close)
+{
+    auto* priv = NOTIFIER_GET_PRIVATE(view);
+    auto* job = new NotificationJob;
+    g_weak_ref_init(&job->view, view);
+    job->notification = notification;
+    job->close = close;
+    notification->busy = true;
+    g_thread_pool_push(priv->cpp->jobs_, job, nullptr);
+}
+
+static gboolean
+notification_job_done(gpointer data)
+{
+    std::unique_ptr<NotificationJob> job(static_cast<NotificationJob*>(data));
+    if (job->error) {
+        if (job->close)
+            g_warning("could not close notification: %s", job->error->message);
+        else
+            g_warning("failed to show notification: %s", job->error->message);
+        g_clear_error(&job->error);
+    }
+
+    auto* view = static_cast<Notifier*>(g_weak_ref_get(&job->view));
+    g_weak_ref_clear(&job->view);
+    if (!view)
+        return G_SOURCE_REMOVE;
+
+    auto& notification = *job->notification;
+    notification.busy = false;
+    if (NOTIFIER_GET_PRIVATE(view)->cpp && !job->close) {
+        if (notification.closed) {
+            queue_notification_job(view, job->notification, true);
+        } else if (notification.reshow) {
+            notification.reshow = false;
+            apply_notification(notification);
+            queue_notification_job(view, job->notification, false);
+        }
+    }
+    g_object_unref(view);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+close_notification(Notifier* view, const std::shared_ptr<Notification>& notification)
+{
+    // once shown if it still is being shown
+    if (notification->busy)
+        notification->closed = true;
+    else
+        queue_notification_job(view, notification, true);
+}
+
+static gboolean
+release_notification(gpointer data)
+{
+    delete static_cast<std::shared_ptr<Notification>*>(data);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+on_notification_closed(NotifyNotification*, Notification* notification)
+{
+    // dismissed or expired on the desktop, the notification is released once
+    // this signal is done with it
+    auto* owner = notification->owner;
+    auto forgotten = owner->forget(notification->id);
+    notification->reshow = false;
+    g_debug("notification closed, %zu left", owner->notifications_.size());
+    g_idle_add(release_notification, new std::shared_ptr<Notification>(std::move(forgotten)));
+}
+
+static void
+run_notification_job(gpointer data, gpointer)
+{
+    auto* job = static_cast<NotificationJob*>(data);
+    auto* nn = job->notification->nn.get();
+    if (job->close)
+        notify_notification_close(nn, &job->error);
+    else
+        notify_notification_show(nn, &job->error);
+    g_idle_add(notification_job_done, job);
+}
+
+#if USE_CANBERRA
+static gboolean
+play_notification_sound(gpointer data)
+{
+    auto* cpp = static_cast<details::CppImpl*>(data);
+    cpp->soundSource_ = 0;
+    cpp->lastSound_ = g_get_monotonic_time();
+    auto status = ca_context_play(ca_gtk_context_get(),
+                                  0,
+                                  CA_PROP_MEDIA_FILENAME,
+                                  NOTIFICATION_FILE,
+                                  nullptr);
+    if (status != 0)
+        g_warning("ca_context_play: %s", ca_strerror(status));
+    return G_SOURCE_REMOVE;
+}
+#endif // USE_CANBERRA
+
 #endif
 
 gboolean
@@ -299,55 +527,61 @@ show_notification(Notifier* view, const std::string& icon,
     NotifierPrivate *priv = NOTIFIER_GET_PRIVATE(view);
 
 #if USE_LIBNOTIFY
-    std::shared_ptr<NotifyNotification> notification(
-        notify_notification_new(title.c_str(), body.c_str(), nullptr), g_object_unref);
-    struct Notification n = {
-        notification,
-        conversation
-    };
-    priv->cpp->notifications_.emplace(id, n);
-
     // Draw icon
-    auto firstLetter = (name == uri || name.empty()) ?
-        "" : QString(QString(name.c_str()).at(0)).toStdString();  // NOTE best way to be compatible with UTF-8
-    GdkPixbuf *default_avatar = draw_generate_avatar(firstLetter, "ring:" + uri);
-    GdkPixbuf *photo = draw_scale_and_frame(default_avatar, QSize(50, 50));
-    g_object_unref(default_avatar);
-    if (!icon.empty()) {
-        QByteArray byteArray(icon.c_str(), icon.length());
-        GdkPixbuf *avatar = draw_person_photo(byteArray);
-        if (avatar) {
-            g_object_unref(photo);
-            photo = draw_scale_and_frame(avatar, QSize(50, 50));
-            g_object_unref(avatar);
+    auto alias = name == uri ? "" : name;
+    std::shared_ptr<GdkPixbuf> photo(avatar_cache_get(uri, alias, "ring:" + uri, icon, QSize(50, 50)),
+                                     g_object_unref);
+
+    // a notification shown again with the same id is updated in place
+    std::shared_ptr<Notification> notification;
+    auto existing = priv->cpp->notifications_.find(id);
+    auto update = existing != priv->cpp->notifications_.end();
+    if (update) {
+        notification = existing->second;
+        if (notification->conversation != conversation) {
+            priv->cpp->unindex(*notification);
+            notification->conversation = conversation;
+            priv->cpp->index(*notification);
         }
-    }
-    notify_notification_set_image_from_pixbuf(notification.get(), photo);
-    g_object_unref(photo);
-
-    if (type != NotificationType::CHAT) {
-        notify_notification_set_urgency(notification.get(), NOTIFY_URGENCY_CRITICAL);
-        notify_notification_set_timeout(notification.get(), NOTIFY_EXPIRES_DEFAULT);
     } else {
-        notify_notification_set_urgency(notification.get(), NOTIFY_URGENCY_NORMAL);
+        notification = std::make_shared<Notification>();
+        notification->nn.reset(notify_notification_new(title.c_str(), body.c_str(), nullptr), g_object_unref);
+        notification->id = id;
+        notification->type = type;
+        notification->conversation = conversation;
+        priv->cpp->track(notification);
     }
+    notification->title = title;
+    notification->body = body;
+    notification->image = photo;
 
 #if USE_CANBERRA
-    if (type != NotificationType::CALL) {
-        auto status = ca_context_play(ca_gtk_context_get(),
-                                      0,
-                                      CA_PROP_MEDIA_FILENAME,
-                                      NOTIFICATION_FILE,
-                                      nullptr);
-        if (status != 0)
-            g_warning("ca_context_play: %s", ca_strerror(status));
-    }
+    // off the way of the notification, and once for a burst of them
+    if (type != NotificationType::CALL && !priv->cpp->soundSource_
+        && g_get_monotonic_time() - priv->cpp->lastSound_ >= SOUND_INTERVAL_US)
+        priv->cpp->soundSource_ = g_idle_add_full(G_PRIORITY_LOW, play_notification_sound, priv->cpp, nullptr);
 #endif // USE_CANBERRA
 
+    if (notification->busy) {
+        notification->reshow = true;
+        return TRUE;
+    }
+    apply_notification(*notification);
+    auto* nn = notification->nn.get();
+
+    if (!update) {
+        if (type != NotificationType::CHAT) {
+            notify_notification_set_urgency(nn, NOTIFY_URGENCY_CRITICAL);
+            notify_notification_set_timeout(nn, NOTIFY_EXPIRES_DEFAULT);
+        } else {
+            notify_notification_set_urgency(nn, NOTIFY_URGENCY_NORMAL);
+        }
+    }
+
     // if the notification server supports actions, make the default action to show the chat view
-    if (priv->cpp->actions) {
+    if (priv->cpp->actions && !update) {
         if (type != NotificationType::CALL) {
-            notify_notification_add_action(notification.get(),
+            notify_notification_add_action(nn,
                 id.c_str(),
                 C_("", "Open conversation"),
                 (NotifyActionCallback)show_chat_view,
@@ -355,14 +589,14 @@ show_notification(Notifier* view, const std::string& icon,
                 nullptr);
             if (type != NotificationType::CHAT) {
                 auto addId = "add:" + id;
-                notify_notification_add_action(notification.get(),
+                notify_notification_add_action(nn,
                     addId.c_str(),
                     C_("", "Accept"),
                     (NotifyActionCallback)accept_pending,
                     view,
                     nullptr);
                 auto rmId = "rm:" + id;
-                notify_notification_add_action(notification.get(),
+                notify_notification_add_action(nn,
                     rmId.c_str(),
                     C_("", "Refuse"),
                     (NotifyActionCallback)refuse_pending,
@@ -371,14 +605,14 @@ show_notification(Notifier* view, const std::string& icon,
             }
         } else {
             auto acceptId = "accept:" + id;
-            notify_notification_add_action(notification.get(),
+            notify_notification_add_action(nn,
                 acceptId.c_str(),
                 C_("", "Accept"),
                 (NotifyActionCallback)accept_call,
                 view,
                 nullptr);
             auto declineId = "decline:" + id;
-            notify_notification_add_action(notification.get(),
+            notify_notification_add_action(nn,
                 declineId.c_str(),
                 C_("", "Decline"),
                 (NotifyActionCallback)decline_call,
@@ -387,13 +621,8 @@ show_notification(Notifier* view, const std::string& icon,
         }
     }
 
-    GError *error = nullptr;
-    success = notify_notification_show(notification.get(), &error);
-
-    if (error) {
-        g_warning("failed to show notification: %s", error->message);
-        g_clear_error(&error);
-    }
+    queue_notification_job(view, notification, false);
+    success = TRUE;
 #endif
     return success;
 }
@@ -405,22 +634,11 @@ hide_notification(Notifier* view, const std::string& id)
     NotifierPrivate *priv = NOTIFIER_GET_PRIVATE(view);
 
 #if USE_LIBNOTIFY
-    // Search
-    auto notification = priv->cpp->notifications_.find(id);
-    if (notification == priv->cpp->notifications_.end()) {
-        return FALSE;
-    }
-
-    // Close
-    GError *error = nullptr;
-    if (!notify_notification_close(notification->second.nn.get(), &error)) {
-        g_warning("could not close notification: %s", error->message);
-        g_clear_error(&error);
+    auto notification = priv->cpp->forget(id);
+    if (!notification) {
         return FALSE;
     }
-
-    // Erase
-    priv->cpp->notifications_.erase(id);
+    close_notification(view, notification);
 #endif
 
     return TRUE;
@@ -448,9 +666,47 @@ get_notification_conversation(Notifier* view, const std::string& id)
 #if USE_LIBNOTIFY
     auto n = priv->cpp->notifications_.find(id);
     if (n != priv->cpp->notifications_.end()) {
-        return n->second.conversation;
+        return n->second->conversation;
     }
 #endif
 
     return {};
 }
+
+gboolean
+hide_conversation_notifications(Notifier* view, const std::string& conversation)
+{
+    g_return_val_if_fail(IS_NOTIFIER(view), false);
+    NotifierPrivate *priv = NOTIFIER_GET_PRIVATE(view);
+
+#if USE_LIBNOTIFY
+    auto it = priv->cpp->conversations_.find(conversation);
+    if (it == priv->cpp->conversations_.end()) {
+        return FALSE;
+    }
+
+    // forget() changes the index
+    auto notifications = std::move(it->second);
+    priv->cpp->conversations_.erase(it);
+    for (auto* tracked : notifications) {
+        if (auto notification = priv->cpp->forget(tracked->id))
+            close_notification(view, notification);
+    }
+    return TRUE;
+#endif
+
+    return FALSE;
+}
+
+guint
+get_notifications_count(Notifier* view)
+{
+    g_return_val_if_fail(IS_NOTIFIER(view), 0);
+    NotifierPrivate *priv = NOTIFIER_GET_PRIVATE(view);
+
+#if USE_LIBNOTIFY
+    return priv->cpp->notifications_.size();
+#endif
+
+    return 0;
+}
@@ -56,6 +56,15 @@ gboolean    show_notification(Notifier* view,
 gboolean    hide_notification(Notifier* view, const std::string& id);
 gboolean    has_notification(Notifier* view, const std::string& id);
 std::string get_notification_conversation(Notifier* view, const std::string& id);
+/**
+ * Hide every notification shown with `conversation'.
+ */
+gboolean    hide_conversation_notifications(Notifier* view, const std::string& conversation);
+/**
+ * The notifications shown and not closed yet, the ones dismissed on the
+ * desktop or expired are forgotten.
+ */
+guint       get_notifications_count(Notifier* view);
 
 G_END_DECLS
 
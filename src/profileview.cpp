@@ -20,6 +20,7 @@
 #include "profileview.h"
 
 #include "utils/drawing.h"
+#include "utils/styleregistry.h"
 
 #include <QSize>
 
@@ -180,16 +181,7 @@ profile_view_new(AccountInfoPointer const & accountInfo, const QString& uid)
     priv->cpp->uid_ = uid;
     if (!build_view(PROFILE_VIEW(view))) return nullptr;
 
-    auto provider = gtk_css_provider_new();
-    std::string css = ".bestname { font-size: 3em; font-weight: 100; }";
-    css += ".section_title { font-size: 1.2em; font-weight: bold; }";
-    css += ".sub_section_title { font-size: 1.2em; opacity: 0.7; }";
-    css += ".value { font-size: 1.2em; }";
-    css += ".empty { font-size: 1.2em; font-style: italic; opacity: 0.7; }";
-    gtk_css_provider_load_from_data(provider, css.c_str(), -1, nullptr);
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/profileview.css");
 
     return static_cast<GtkWidget*>(view);
 }
@@ -0,0 +1,711 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "unifiedconversationsview.h"
+
+// std
+#include <chrono>
+#include <ctime>
+#include <iomanip> // for std::put_time
+#include <map>
+#include <queue>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+// GTK+ related
+#include <QSize>
+
+// LRC
+#include <api/account.h>
+#include <api/contact.h>
+#include <api/contactmodel.h>
+#include <api/conversation.h>
+#include <api/conversationmodel.h>
+#include <api/lrc.h>
+#include <api/newaccountmodel.h>
+
+// Gnome client
+#include "marshals.h"
+#include "utils/drawing.h"
+
+enum {
+    COLUMN_ACCOUNT_ID,
+    COLUMN_CONVERSATION_UID,
+    COLUMN_TIMESTAMP, /* of the last interaction, the rows are sorted on it */
+    N_COLUMNS
+};
+
+struct _UnifiedConversationsView
+{
+    GtkTreeView parent;
+};
+
+struct _UnifiedConversationsViewClass
+{
+    GtkTreeViewClass parent_class;
+};
+
+typedef struct _UnifiedConversationsViewPrivate UnifiedConversationsViewPrivate;
+
+namespace { namespace details {
+class CppImpl;
+}}
+
+struct _UnifiedConversationsViewPrivate
+{
+    bool useDarkTheme {false};
+    details::CppImpl* cpp {nullptr};
+};
+
+G_DEFINE_TYPE_WITH_PRIVATE(UnifiedConversationsView, unified_conversations_view, GTK_TYPE_TREE_VIEW);
+
+#define UNIFIED_CONVERSATIONS_VIEW_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), UNIFIED_CONVERSATIONS_VIEW_TYPE, UnifiedConversationsViewPrivate))
+
+enum {
+    CONVERSATION_SELECTED,
+    LAST_SIGNAL
+};
+
+static guint unified_conversations_view_signals[LAST_SIGNAL] = { 0 };
+
+static std::time_t
+last_interaction_time(const lrc::api::conversation::Info& conversation)
+{
+    auto it = conversation.interactions->find(conversation.lastMessageUid);
+    return it != conversation.interactions->end() ? it->second.timestamp : 0;
+}
+
+static QString
+conversation_selected_uid(UnifiedConversationsView* self, const QString& accountId)
+{
+    auto* selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(self));
+    GtkTreeModel* model = nullptr;
+    GtkTreeIter iter;
+    if (!gtk_tree_selection_get_selected(selection, &model, &iter))
+        return {};
+
+    gchar* rowAccountId = nullptr;
+    gchar* uid = nullptr;
+    gtk_tree_model_get(model, &iter,
+                       COLUMN_ACCOUNT_ID, &rowAccountId,
+                       COLUMN_CONVERSATION_UID, &uid,
+                       -1);
+    QString result;
+    if (accountId == rowAccountId)
+        result = uid;
+    g_free(rowAccountId);
+    g_free(uid);
+    return result;
+}
+
+namespace { namespace details {
+
+class CppImpl
+{
+public:
+    explicit CppImpl(UnifiedConversationsView& widget, lrc::api::Lrc& lrc);
+    ~CppImpl();
+
+    using Conversations = std::vector<const lrc::api::conversation::Info*>;
+
+    const lrc::api::account::Info* accountInfo(const QString& accountId) const;
+    OptRef<lrc::api::conversation::Info> conversation(GtkTreeModel* model, GtkTreeIter* iter) const;
+
+    void track(const QString& accountId);
+    void untrack(const QString& accountId);
+    void fill();
+    void scheduleMerge(const QString& accountId);
+    void merge(const QString& accountId);
+    void removeRows(const QString& accountId, const QString& uid = {});
+    void updateRow(const QString& accountId, const QString& uid);
+    void moveRow(GtkTreeIter* row, std::time_t timestamp);
+
+    static gboolean onMerge(gpointer self);
+
+    UnifiedConversationsView* self = nullptr; // The GTK widget itself
+    lrc::api::Lrc& lrc;
+    GtkListStore* store = nullptr;
+    // rows of the store by account, then by conversation. The iters of a
+    // GtkListStore stay valid as long as their row exists
+    std::map<QString, std::map<QString, GtkTreeIter>> rows;
+
+    // the rows are changed by the view itself, not by the user
+    bool updating = false;
+
+    // accounts shown, their models are merged again when they change
+    std::map<QString, std::vector<QMetaObject::Connection>> accounts;
+    std::set<QString> pendingMerges;
+    guint mergeSource = 0;
+
+    QMetaObject::Connection accountAddedConnection;
+    QMetaObject::Connection accountRemovedConnection;
+    QMetaObject::Connection accountStatusChangedConnection;
+};
+
+/**
+ * The conversations of an account, in the order of its model: the most
+ * recent first. Only pointers are taken, the conversations stay in LRC.
+ */
+static CppImpl::Conversations
+sorted_conversations(const lrc::api::account::Info& accountInfo)
+{
+    CppImpl::Conversations conversations;
+    for (const lrc::api::conversation::Info& conversation :
+             accountInfo.conversationModel->getFilteredConversations(accountInfo.profileInfo.type).get())
+        conversations.emplace_back(&conversation);
+    return conversations;
+}
+
+CppImpl::CppImpl(UnifiedConversationsView& widget, lrc::api::Lrc& lrc)
+    : self {&widget}
+    , lrc {lrc}
+{
+    auto& accountModel = lrc.getAccountModel();
+    for (const auto& accountId : accountModel.getAccountList())
+        track(accountId);
+
+    accountAddedConnection = QObject::connect(&accountModel,
+                                              &lrc::api::NewAccountModel::accountAdded,
+                                              [this] (const QString& id) {
+                                                  track(id);
+                                                  scheduleMerge(id);
+                                              });
+    accountRemovedConnection = QObject::connect(&accountModel,
+                                                &lrc::api::NewAccountModel::accountRemoved,
+                                                [this] (const QString& id) {
+                                                    untrack(id);
+                                                    removeRows(id);
+                                                });
+    accountStatusChangedConnection = QObject::connect(&accountModel,
+                                                      &lrc::api::NewAccountModel::accountStatusChanged,
+                                                      [this] (const QString& id) {
+                                                          // enabled or disabled
+                                                          auto* info = accountInfo(id);
+                                                          auto tracked = accounts.find(id) != accounts.end();
+                                                          if (info && info->enabled && !tracked) {
+                                                              track(id);
+                                                              scheduleMerge(id);
+                                                          } else if ((!info || !info->enabled) && tracked) {
+                                                              untrack(id);
+                                                              removeRows(id);
+                                                          }
+                                                      });
+}
+
+CppImpl::~CppImpl()
+{
+    QObject::disconnect(accountAddedConnection);
+    QObject::disconnect(accountRemovedConnection);
+    QObject::disconnect(accountStatusChangedConnection);
+    while (!accounts.empty())
+        untrack(accounts.begin()->first);
+
+    if (mergeSource)
+        g_source_remove(mergeSource);
+    g_clear_object(&store);
+}
+
+const lrc::api::account::Info*
+CppImpl::accountInfo(const QString& accountId) const
+{
+    try {
+        return &lrc.getAccountModel().getAccountInfo(accountId);
+    } catch (const std::out_of_range&) {
+        return nullptr;
+    }
+}
+
+OptRef<lrc::api::conversation::Info>
+CppImpl::conversation(GtkTreeModel* model, GtkTreeIter* iter) const
+{
+    gchar* accountId = nullptr;
+    gchar* uid = nullptr;
+    gtk_tree_model_get(model, iter,
+                       COLUMN_ACCOUNT_ID, &accountId,
+                       COLUMN_CONVERSATION_UID, &uid,
+                       -1);
+    OptRef<lrc::api::conversation::Info> result;
+    if (auto* info = accountInfo(accountId))
+        result = info->conversationModel->getConversationForUid(uid);
+    g_free(accountId);
+    g_free(uid);
+    return result;
+}
+
+void
+CppImpl::track(const QString& accountId)
+{
+    auto* info = accountInfo(accountId);
+    if (!info || !info->enabled || accounts.find(accountId) != accounts.end())
+        return;
+
+    auto& connections = accounts[accountId];
+    auto* model = &*info->conversationModel;
+    connections.emplace_back(QObject::connect(model,
+                                              &lrc::api::ConversationModel::modelChanged,
+                                              [this, accountId] { scheduleMerge(accountId); }));
+    connections.emplace_back(QObject::connect(model,
+                                              &lrc::api::ConversationModel::conversationUpdated,
+                                              [this, accountId] (const QString& uid) { updateRow(accountId, uid); }));
+    connections.emplace_back(QObject::connect(model,
+                                              &lrc::api::ConversationModel::conversationRemoved,
+                                              [this, accountId] (const QString& uid) { removeRows(accountId, uid); }));
+}
+
+void
+CppImpl::untrack(const QString& accountId)
+{
+    auto it = accounts.find(accountId);
+    if (it == accounts.end())
+        return;
+    for (auto& connection : it->second)
+        QObject::disconnect(connection);
+    accounts.erase(it);
+    pendingMerges.erase(accountId);
+}
+
+void
+CppImpl::fill()
+{
+    // k-way merge of the lists of every account, already sorted by LRC
+    struct Cursor {
+        std::time_t timestamp;
+        const QString* accountId;
+        const Conversations* conversations;
+        std::size_t index;
+    };
+    auto older = [] (const Cursor& a, const Cursor& b) { return a.timestamp < b.timestamp; };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(older)> heads(older);
+
+    std::map<QString, Conversations> lists;
+    for (const auto& account : accounts) {
+        auto* info = accountInfo(account.first);
+        if (!info)
+            continue;
+        auto& conversations = lists[account.first] = sorted_conversations(*info);
+        if (!conversations.empty())
+            heads.push({last_interaction_time(*conversations.front()), &account.first, &conversations, 0});
+    }
+
+    rows.clear();
+    auto* newStore = gtk_list_store_new(N_COLUMNS, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_INT64);
+    while (!heads.empty()) {
+        auto head = heads.top();
+        heads.pop();
+        const auto& conversation = *(*head.conversations)[head.index];
+        GtkTreeIter row;
+        gtk_list_store_insert_with_values(newStore, &row, -1,
+                                          COLUMN_ACCOUNT_ID, qUtf8Printable(*head.accountId),
+                                          COLUMN_CONVERSATION_UID, qUtf8Printable(conversation.uid),
+                                          COLUMN_TIMESTAMP, (gint64) head.timestamp,
+                                          -1);
+        rows[*head.accountId][conversation.uid] = row;
+        if (++head.index < head.conversations->size()) {
+            head.timestamp = last_interaction_time(*(*head.conversations)[head.index]);
+            heads.push(head);
+        }
+    }
+
+    updating = true;
+    gtk_tree_view_set_model(GTK_TREE_VIEW(self), GTK_TREE_MODEL(newStore));
+    updating = false;
+    g_clear_object(&store);
+    store = newStore;
+}
+
+void
+CppImpl::scheduleMerge(const QString& accountId)
+{
+    // modelChanged comes in bursts, merge once the burst is over
+    pendingMerges.emplace(accountId);
+    if (!mergeSource)
+        mergeSource = g_idle_add(onMerge, this);
+}
+
+gboolean
+CppImpl::onMerge(gpointer self)
+{
+    auto* impl = static_cast<CppImpl*>(self);
+    impl->mergeSource = 0;
+    auto pending = std::move(impl->pendingMerges);
+    impl->pendingMerges.clear();
+    for (const auto& accountId : pending)
+        impl->merge(accountId);
+    return G_SOURCE_REMOVE;
+}
+
+void
+CppImpl::merge(const QString& accountId)
+{
+    if (accounts.find(accountId) == accounts.end())
+        return;
+    auto* info = accountInfo(accountId);
+    if (!info || !store)
+        return;
+
+    // only the rows of this account move, the others are left as they are
+    auto selected = conversation_selected_uid(self, accountId);
+    updating = true;
+    removeRows(accountId);
+
+    auto* model = GTK_TREE_MODEL(store);
+    GtkTreeIter iter;
+    auto valid = gtk_tree_model_get_iter_first(model, &iter);
+    for (const auto* conversation : sorted_conversations(*info)) {
+        auto timestamp = last_interaction_time(*conversation);
+        while (valid) {
+            gint64 rowTimestamp = 0;
+            gtk_tree_model_get(model, &iter, COLUMN_TIMESTAMP, &rowTimestamp, -1);
+            if (rowTimestamp < timestamp)
+                break;
+            valid = gtk_tree_model_iter_next(model, &iter);
+        }
+        GtkTreeIter row;
+        gtk_list_store_insert_before(store, &row, valid ? &iter : nullptr);
+        gtk_list_store_set(store, &row,
+                           COLUMN_ACCOUNT_ID, qUtf8Printable(accountId),
+                           COLUMN_CONVERSATION_UID, qUtf8Printable(conversation->uid),
+                           COLUMN_TIMESTAMP, (gint64) timestamp,
+                           -1);
+        rows[accountId][conversation->uid] = row;
+        if (!selected.isEmpty() && conversation->uid == selected)
+            gtk_tree_selection_select_iter(gtk_tree_view_get_selection(GTK_TREE_VIEW(self)), &row);
+    }
+    updating = false;
+}
+
+void
+CppImpl::removeRows(const QString& accountId, const QString& uid)
+{
+    auto account = rows.find(accountId);
+    if (!store || account == rows.end())
+        return;
+
+    if (uid.isEmpty()) {
+        for (auto& row : account->second)
+            gtk_list_store_remove(store, &row.second);
+        rows.erase(account);
+        return;
+    }
+    auto row = account->second.find(uid);
+    if (row == account->second.end())
+        return;
+    gtk_list_store_remove(store, &row->second);
+    account->second.erase(row);
+}
+
+void
+CppImpl::updateRow(const QString& accountId, const QString& uid)
+{
+    auto account = rows.find(accountId);
+    if (!store || account == rows.end())
+        return;
+    auto row = account->second.find(uid);
+    if (row == account->second.end())
+        return;
+
+    auto* info = accountInfo(accountId);
+    auto conversationOpt = info ? info->conversationModel->getConversationForUid(uid)
+                                : OptRef<lrc::api::conversation::Info>();
+    if (!conversationOpt)
+        return;
+
+    auto* model = GTK_TREE_MODEL(store);
+    auto& iter = row->second;
+    gint64 rowTimestamp = 0;
+    gtk_tree_model_get(model, &iter, COLUMN_TIMESTAMP, &rowTimestamp, -1);
+    auto timestamp = last_interaction_time(conversationOpt->get());
+    if (timestamp == rowTimestamp) {
+        // same place, just draw it again
+        auto* path = gtk_tree_model_get_path(model, &iter);
+        gtk_tree_model_row_changed(model, path, &iter);
+        gtk_tree_path_free(path);
+    } else {
+        // new interaction, only this row moves
+        moveRow(&iter, timestamp);
+    }
+}
+
+void
+CppImpl::moveRow(GtkTreeIter* row, std::time_t timestamp)
+{
+    updating = true;
+    gtk_list_store_set(store, row, COLUMN_TIMESTAMP, (gint64) timestamp, -1);
+
+    // first other row which is older, usually one of the first ones
+    auto* model = GTK_TREE_MODEL(store);
+    GtkTreeIter iter;
+    auto valid = gtk_tree_model_get_iter_first(model, &iter);
+    while (valid) {
+        if (iter.user_data != row->user_data) {
+            gint64 rowTimestamp = 0;
+            gtk_tree_model_get(model, &iter, COLUMN_TIMESTAMP, &rowTimestamp, -1);
+            if (rowTimestamp < timestamp)
+                break;
+        }
+        valid = gtk_tree_model_iter_next(model, &iter);
+    }
+    gtk_list_store_move_before(store, row, valid ? &iter : nullptr);
+    updating = false;
+}
+
+}} // namespace details
+
+static void
+render_photo(G_GNUC_UNUSED GtkTreeViewColumn *tree_column,
+             GtkCellRenderer *cell,
+             GtkTreeModel *model,
+             GtkTreeIter *iter,
+             UnifiedConversationsView *self)
+{
+    auto* priv = UNIFIED_CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    if (!priv->cpp)
+        return;
+
+    GdkPixbuf* photo = nullptr;
+    if (auto conversationOpt = priv->cpp->conversation(model, iter)) {
+        const auto& conversation = conversationOpt->get();
+        gchar* accountId = nullptr;
+        gtk_tree_model_get(model, iter, COLUMN_ACCOUNT_ID, &accountId, -1);
+        if (auto* info = priv->cpp->accountInfo(accountId)) {
+            auto isPresent = false;
+            auto contacts = info->conversationModel->peersForConversation(conversation.uid);
+            if (!contacts.empty()) {
+                try {
+                    isPresent = info->contactModel->getContact(contacts.front()).isPresent;
+                } catch (...) { }
+            }
+            photo = draw_conversation_photo(conversation, *info, QSize(50, 50), isPresent);
+        }
+        g_free(accountId);
+    }
+
+    g_object_set(G_OBJECT(cell), "width", 50, NULL);
+    g_object_set(G_OBJECT(cell), "pixbuf", photo, NULL);
+    if (photo)
+        g_object_unref(photo);
+}
+
+static void
+render_name_and_account(G_GNUC_UNUSED GtkTreeViewColumn *tree_column,
+                        GtkCellRenderer *cell,
+                        GtkTreeModel *model,
+                        GtkTreeIter *iter,
+                        UnifiedConversationsView *self)
+{
+    auto* priv = UNIFIED_CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    if (!priv->cpp)
+        return;
+
+    gchar* accountId = nullptr;
+    gtk_tree_model_get(model, iter, COLUMN_ACCOUNT_ID, &accountId, -1);
+    auto* info = priv->cpp->accountInfo(accountId);
+    auto conversationOpt = priv->cpp->conversation(model, iter);
+    g_free(accountId);
+    if (!info || !conversationOpt) {
+        g_object_set(G_OBJECT(cell), "markup", "", NULL);
+        return;
+    }
+
+    const auto& conversation = conversationOpt->get();
+    auto title = info->conversationModel->title(conversation.uid);
+    title.remove('\r');
+    auto it = conversation.interactions->find(conversation.lastMessageUid);
+    auto lastMessage = it != conversation.interactions->end() ? it->second.body : QString();
+    lastMessage.replace('\n', ' ');
+    auto account = info->profileInfo.alias.isEmpty() ? info->registeredName : info->profileInfo.alias;
+    if (account.isEmpty())
+        account = info->profileInfo.uri;
+
+    auto grey = priv->useDarkTheme ? "#bbb" : "#666";
+    auto badge = priv->useDarkTheme ? "#2d5b80" : "#cfe3f5";
+    auto* text = g_markup_printf_escaped(
+        "<span font_weight=\"bold\">%s</span>\n<span size=\"smaller\" color=\"%s\">%s</span>\n"
+        "<span size=\"smaller\" background=\"%s\"> %s </span>",
+        qUtf8Printable(title),
+        grey,
+        qUtf8Printable(lastMessage),
+        badge,
+        qUtf8Printable(account));
+    g_object_set(G_OBJECT(cell), "markup", text, NULL);
+    g_free(text);
+}
+
+static void
+render_time(G_GNUC_UNUSED GtkTreeViewColumn *tree_column,
+            GtkCellRenderer *cell,
+            GtkTreeModel *model,
+            GtkTreeIter *iter,
+            G_GNUC_UNUSED UnifiedConversationsView *self)
+{
+    gint64 timestamp = 0;
+    gtk_tree_model_get(model, iter, COLUMN_TIMESTAMP, &timestamp, -1);
+    if (!timestamp) {
+        g_object_set(G_OBJECT(cell), "markup", "", NULL);
+        return;
+    }
+
+    std::time_t lastTimestamp = timestamp;
+    auto diff = std::chrono::duration_cast<std::chrono::hours>(
+        std::chrono::system_clock::now() - std::chrono::system_clock::from_time_t(lastTimestamp));
+    std::stringstream date;
+    date << std::put_time(std::localtime(&lastTimestamp), diff.count() < 24 ? "%R" : "%x");
+    auto* text = g_markup_printf_escaped("<span size=\"smaller\" color=\"#666\">%s</span>", date.str().c_str());
+    g_object_set(G_OBJECT(cell), "markup", text, NULL);
+    g_free(text);
+}
+
+static void
+select_conversation(GtkTreeSelection *selection, UnifiedConversationsView *self)
+{
+    auto* priv = UNIFIED_CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    if (!priv->cpp || priv->cpp->updating)
+        return;
+
+    GtkTreeModel* model = nullptr;
+    GtkTreeIter iter;
+    if (!gtk_tree_selection_get_selected(selection, &model, &iter))
+        return;
+
+    gchar* accountId = nullptr;
+    gchar* uid = nullptr;
+    gtk_tree_model_get(model, &iter,
+                       COLUMN_ACCOUNT_ID, &accountId,
+                       COLUMN_CONVERSATION_UID, &uid,
+                       -1);
+    g_signal_emit(G_OBJECT(self), unified_conversations_view_signals[CONVERSATION_SELECTED], 0,
+                  accountId, uid);
+    g_free(accountId);
+    g_free(uid);
+}
+
+static void
+call_conversation(GtkTreeView *self,
+                  GtkTreePath *path,
+                  G_GNUC_UNUSED GtkTreeViewColumn *column,
+                  G_GNUC_UNUSED gpointer user_data)
+{
+    auto* priv = UNIFIED_CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    auto* model = gtk_tree_view_get_model(self);
+    GtkTreeIter iter;
+    if (!priv->cpp || !gtk_tree_model_get_iter(model, &iter, path))
+        return;
+
+    gchar* accountId = nullptr;
+    gchar* uid = nullptr;
+    gtk_tree_model_get(model, &iter,
+                       COLUMN_ACCOUNT_ID, &accountId,
+                       COLUMN_CONVERSATION_UID, &uid,
+                       -1);
+    if (auto* info = priv->cpp->accountInfo(accountId))
+        info->conversationModel->placeCall(uid);
+    g_free(accountId);
+    g_free(uid);
+}
+
+static void
+build_unified_conversations_view(UnifiedConversationsView *self)
+{
+    gtk_tree_view_set_headers_visible(GTK_TREE_VIEW(self), FALSE);
+    gtk_tree_view_set_enable_search(GTK_TREE_VIEW(self), false);
+
+    auto area = gtk_cell_area_box_new();
+    auto column = gtk_tree_view_column_new_with_area(area);
+
+    auto renderer = gtk_cell_renderer_pixbuf_new();
+    gtk_cell_area_box_pack_start(GTK_CELL_AREA_BOX(area), renderer, FALSE, FALSE, FALSE);
+    gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                            (GtkTreeCellDataFunc)render_photo, self, NULL);
+
+    renderer = gtk_cell_renderer_text_new();
+    g_object_set(G_OBJECT(renderer), "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+    gtk_cell_area_box_pack_start(GTK_CELL_AREA_BOX(area), renderer, FALSE, FALSE, FALSE);
+    gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                            (GtkTreeCellDataFunc)render_name_and_account, self, NULL);
+
+    renderer = gtk_cell_renderer_text_new();
+    g_object_set(G_OBJECT(renderer), "ellipsize", PANGO_ELLIPSIZE_END, NULL);
+    g_object_set(G_OBJECT(renderer), "xalign", 1.0, NULL);
+    gtk_cell_area_box_pack_start(GTK_CELL_AREA_BOX(area), renderer, FALSE, FALSE, FALSE);
+    gtk_tree_view_column_set_cell_data_func(column, renderer,
+                                            (GtkTreeCellDataFunc)render_time, self, NULL);
+
+    gtk_tree_view_append_column(GTK_TREE_VIEW(self), column);
+
+    auto selection = gtk_tree_view_get_selection(GTK_TREE_VIEW(self));
+    g_signal_connect(selection, "changed", G_CALLBACK(select_conversation), self);
+    g_signal_connect(self, "row-activated", G_CALLBACK(call_conversation), NULL);
+
+    gtk_widget_show_all(GTK_WIDGET(self));
+}
+
+static void
+unified_conversations_view_init(G_GNUC_UNUSED UnifiedConversationsView *self)
+{
+    // Nothing to do
+}
+
+static void
+unified_conversations_view_dispose(GObject *object)
+{
+    auto* priv = UNIFIED_CONVERSATIONS_VIEW_GET_PRIVATE(object);
+
+    delete priv->cpp;
+    priv->cpp = nullptr;
+
+    G_OBJECT_CLASS(unified_conversations_view_parent_class)->dispose(object);
+}
+
+static void
+unified_conversations_view_class_init(UnifiedConversationsViewClass *klass)
+{
+    G_OBJECT_CLASS(klass)->dispose = unified_conversations_view_dispose;
+
+    unified_conversations_view_signals[CONVERSATION_SELECTED] = g_signal_new(
+        "conversation-selected",
+        G_TYPE_FROM_CLASS(klass),
+        (GSignalFlags) (G_SIGNAL_RUN_FIRST | G_SIGNAL_ACTION),
+        0,
+        nullptr,
+        nullptr,
+        g_cclosure_user_marshal_VOID__STRING_STRING,
+        G_TYPE_NONE, 2, G_TYPE_STRING, G_TYPE_STRING);
+}
+
+GtkWidget *
+unified_conversations_view_new(lrc::api::Lrc& lrc)
+{
+    auto* self = UNIFIED_CONVERSATIONS_VIEW(g_object_new(UNIFIED_CONVERSATIONS_VIEW_TYPE, NULL));
+    auto* priv = UNIFIED_CONVERSATIONS_VIEW_GET_PRIVATE(self);
+
+    build_unified_conversations_view(self);
+    priv->cpp = new details::CppImpl(*self, lrc);
+    priv->cpp->fill();
+
+    return GTK_WIDGET(self);
+}
+
+void
+unified_conversations_view_set_theme(UnifiedConversationsView *self, bool darkTheme)
+{
+    g_return_if_fail(IS_UNIFIED_CONVERSATIONS_VIEW(self));
+    auto* priv = UNIFIED_CONVERSATIONS_VIEW_GET_PRIVATE(self);
+    priv->useDarkTheme = darkTheme;
+}
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#include <gtk/gtk.h>
+
+namespace lrc
+{
+namespace api
+{
+class Lrc;
+}
+}
+
+G_BEGIN_DECLS
+
+#define UNIFIED_CONVERSATIONS_VIEW_TYPE            (unified_conversations_view_get_type ())
+#define UNIFIED_CONVERSATIONS_VIEW(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), UNIFIED_CONVERSATIONS_VIEW_TYPE, UnifiedConversationsView))
+#define UNIFIED_CONVERSATIONS_VIEW_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST((klass), UNIFIED_CONVERSATIONS_VIEW_TYPE, UnifiedConversationsViewClass))
+#define IS_UNIFIED_CONVERSATIONS_VIEW(obj)         (G_TYPE_CHECK_INSTANCE_TYPE((obj), UNIFIED_CONVERSATIONS_VIEW_TYPE))
+#define IS_UNIFIED_CONVERSATIONS_VIEW_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE((klass), UNIFIED_CONVERSATIONS_VIEW_TYPE))
+
+typedef struct _UnifiedConversationsView      UnifiedConversationsView;
+typedef struct _UnifiedConversationsViewClass UnifiedConversationsViewClass;
+
+/**
+ * The conversations of every enabled account in one list, most recent first,
+ * with the account of each row. Selecting a row emits "conversation-selected"
+ * with the account id and the conversation uid.
+ */
+GType       unified_conversations_view_get_type (void) G_GNUC_CONST;
+GtkWidget  *unified_conversations_view_new      (lrc::api::Lrc& lrc);
+void        unified_conversations_view_set_theme(UnifiedConversationsView *self, bool darkTheme);
+
+G_END_DECLS
@@ -27,6 +27,7 @@
 
 // Jami  Client
 #include "usernameregistrationbox.h"
+#include "utils/styleregistry.h"
 
 struct _UsernameRegistrationBox
 {
@@ -462,12 +463,7 @@ build_view(UsernameRegistrationBox *view, gboolean register_button)
         gtk_widget_hide(priv->button_register_username);
 
     // CSS styles
-    auto provider = gtk_css_provider_new();
-    std::string css = ".box_error { background: #de8484; }";
-    gtk_css_provider_load_from_data(provider, css.c_str(), -1, nullptr);
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/usernameregistrationbox.css");
 }
 
 GtkWidget *
@@ -0,0 +1,128 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "avatarcache.h"
+
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+#include <QByteArray>
+
+/* the least recently drawn avatars are dropped past this */
+static constexpr std::size_t MAX_AVATARS = 512;
+
+namespace {
+
+struct Avatar {
+    std::string key;
+    std::string id;
+    // what the avatar was drawn from
+    std::size_t photoHash;
+    std::size_t photoLength;
+    std::string alias;
+    GdkPixbuf* pixbuf;
+};
+
+// most recently drawn first
+std::list<Avatar> avatars;
+std::unordered_map<std::string, std::list<Avatar>::iterator> index;
+
+} // namespace
+
+static GdkPixbuf *
+draw_avatar(const std::string& alias,
+            const std::string& uri,
+            const std::string& photo,
+            const QSize& size,
+            gboolean displayInformation,
+            IconStatus status)
+{
+    if (!photo.empty()) {
+        QByteArray byteArray(photo.c_str(), photo.length());
+        if (auto* decoded = draw_person_photo(byteArray)) {
+            auto* result = draw_scale_and_frame(decoded, size, displayInformation, status);
+            g_object_unref(decoded);
+            return result;
+        }
+    }
+
+    auto* generated = draw_generate_avatar(alias, uri);
+    auto* result = draw_scale_and_frame(generated, size, displayInformation, status);
+    g_object_unref(generated);
+    return result;
+}
+
+static void
+drop_avatar(std::list<Avatar>::iterator it)
+{
+    g_object_unref(it->pixbuf);
+    index.erase(it->key);
+    avatars.erase(it);
+}
+
+GdkPixbuf *
+avatar_cache_get(const std::string& id,
+                 const std::string& alias,
+                 const std::string& uri,
+                 const std::string& photo,
+                 const QSize& size,
+                 gboolean displayInformation,
+                 IconStatus status)
+{
+    auto key = id + '\n' + std::to_string(size.height())
+        + (displayInformation ? ":" + std::to_string(static_cast<int>(status)) : "");
+    auto photoHash = std::hash<std::string>()(photo);
+
+    auto found = index.find(key);
+    if (found != index.end()) {
+        auto it = found->second;
+        if (it->photoHash == photoHash && it->photoLength == photo.length() && it->alias == alias) {
+            avatars.splice(avatars.begin(), avatars, it);
+            return GDK_PIXBUF(g_object_ref(it->pixbuf));
+        }
+        // the profile changed
+        drop_avatar(it);
+    }
+
+    auto* pixbuf = draw_avatar(alias, uri, photo, size, displayInformation, status);
+    avatars.push_front({key, id, photoHash, photo.length(), alias, GDK_PIXBUF(g_object_ref(pixbuf))});
+    index.emplace(key, avatars.begin());
+    while (avatars.size() > MAX_AVATARS)
+        drop_avatar(std::prev(avatars.end()));
+
+    return pixbuf;
+}
+
+void
+avatar_cache_invalidate(const std::string& id)
+{
+    for (auto it = avatars.begin(); it != avatars.end();) {
+        auto next = std::next(it);
+        if (it->id == id)
+            drop_avatar(it);
+        it = next;
+    }
+}
+
+void
+avatar_cache_clear(void)
+{
+    while (!avatars.empty())
+        drop_avatar(avatars.begin());
+}
@@ -0,0 +1,60 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef _AVATARCACHE_H
+#define _AVATARCACHE_H
+
+#include <gtk/gtk.h>
+
+#include <QSize>
+
+#include <string>
+
+#include "drawing.h"
+
+G_BEGIN_DECLS
+
+/**
+ * Framed avatars of the people and accounts drawn over and over, like in the
+ * notifications or the account selector, so the photo is decoded and scaled
+ * once per size.
+ *
+ * `id' identifies who is drawn. `photo' is the profile photo, base64 or hex;
+ * if it is empty or can't be decoded, the generated avatar of `alias' and
+ * `uri' is drawn instead, as draw_generate_avatar() does. An entry is drawn
+ * again when the photo or the alias it was drawn from changed, so callers just
+ * pass the current profile.
+ *
+ * Returns a new reference.
+ */
+GdkPixbuf *avatar_cache_get(const std::string& id,
+                            const std::string& alias,
+                            const std::string& uri,
+                            const std::string& photo,
+                            const QSize& size,
+                            gboolean displayInformation = false,
+                            IconStatus status = IconStatus::INVALID);
+/**
+ * Drop every avatar of `id', when its profile changed.
+ */
+void avatar_cache_invalidate(const std::string& id);
+void avatar_cache_clear(void);
+
+G_END_DECLS
+
+#endif /* _AVATARCACHE_H */
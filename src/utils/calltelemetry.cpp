@@ -0,0 +1,526 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "calltelemetry.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <gio/gio.h>
+#include <glib/gstdio.h>
+
+// Qt
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+// Lrc
+#include <api/behaviorcontroller.h>
+#include <api/call.h>
+#include <api/lrc.h>
+#include <api/newaccountmodel.h>
+#include <api/newcallmodel.h>
+#include <smartinfohub.h>
+
+/* the SmartInfo is recorded at most this often */
+static constexpr gint64 SAMPLE_INTERVAL_US = G_USEC_PER_SEC;
+
+namespace {
+
+struct Timeline {
+    FILE* file;
+    std::string path;
+    gint64 start; // monotonic time, the events are relative to it
+    gint64 size;
+    bool truncated;
+    std::string codecs; // the last ones recorded
+};
+
+struct Telemetry {
+    lrc::api::Lrc* lrc;
+    std::string dir;
+    gint64 maxSize;
+    std::map<std::string, Timeline> timelines; // by call
+    QMetaObject::Connection statusConnection;
+    QMetaObject::Connection smartInfoConnection;
+    gint64 lastSample {0};
+};
+
+Telemetry* telemetry = nullptr;
+
+} // namespace
+
+static std::string
+timelines_dir()
+{
+    gchar* dir;
+#if GLIB_CHECK_VERSION(2,72,0)
+    dir = g_build_filename(g_get_user_state_dir(), "jami-gnome", "calls", nullptr);
+#else
+    auto* state_home = g_getenv("XDG_STATE_HOME");
+    if (state_home && g_path_is_absolute(state_home))
+        dir = g_build_filename(state_home, "jami-gnome", "calls", nullptr);
+    else
+        dir = g_build_filename(g_get_home_dir(), ".local", "state", "jami-gnome", "calls", nullptr);
+#endif
+    std::string path = dir;
+    g_free(dir);
+    return path;
+}
+
+/* the names of the timelines, oldest first */
+static std::vector<std::string>
+list_timelines(const std::string& dir)
+{
+    std::vector<std::string> names;
+    if (auto* gdir = g_dir_open(dir.c_str(), 0, nullptr)) {
+        while (auto* name = g_dir_read_name(gdir)) {
+            if (g_str_has_suffix(name, ".jsonl"))
+                names.emplace_back(name);
+        }
+        g_dir_close(gdir);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+static void
+rotate_timelines()
+{
+    std::vector<std::pair<std::string, gint64>> files;
+    gint64 total = 0;
+    for (const auto& name : list_timelines(telemetry->dir)) {
+        auto path = telemetry->dir + G_DIR_SEPARATOR_S + name;
+        GStatBuf st;
+        if (g_stat(path.c_str(), &st) == 0) {
+            files.emplace_back(path, st.st_size);
+            total += st.st_size;
+        }
+    }
+
+    for (const auto& [path, size] : files) {
+        if (total <= telemetry->maxSize)
+            break;
+        auto open = std::any_of(telemetry->timelines.begin(), telemetry->timelines.end(),
+                                [&path = path](const auto& timeline) {
+                                    return timeline.second.path == path;
+                                });
+        if (open)
+            continue;
+        if (g_remove(path.c_str()) == 0)
+            total -= size;
+    }
+}
+
+static bool
+smart_info_displayed()
+{
+    auto* app = g_application_get_default();
+    auto* action = app ? g_action_map_lookup_action(G_ACTION_MAP(app), "display-smartinfo") : nullptr;
+    if (!action)
+        return false;
+    auto* state = g_action_get_state(action);
+    bool displayed = g_variant_get_boolean(state);
+    g_variant_unref(state);
+    return displayed;
+}
+
+/* `text' is UTF-8, which JSON takes as is: only the quotes, the backslashes
+ * and the control characters are escaped */
+gchar*
+json_string(const gchar* text)
+{
+    auto* json = g_string_sized_new(strlen(text) + 2);
+    g_string_append_c(json, '"');
+    for (auto* c = text; *c; ++c) {
+        switch (*c) {
+        case '"':
+            g_string_append(json, "\\\"");
+            break;
+        case '\\':
+            g_string_append(json, "\\\\");
+            break;
+        case '\n':
+            g_string_append(json, "\\n");
+            break;
+        case '\r':
+            g_string_append(json, "\\r");
+            break;
+        case '\t':
+            g_string_append(json, "\\t");
+            break;
+        default:
+            if (static_cast<guchar>(*c) < 0x20)
+                g_string_append_printf(json, "\\u%04x", static_cast<guchar>(*c));
+            else
+                g_string_append_c(json, *c);
+        }
+    }
+    g_string_append_c(json, '"');
+    return g_string_free(json, FALSE);
+}
+
+/* `fields' are appended to the line, each after a comma */
+static void
+write_line(Timeline& timeline, const gchar* event, const gchar* fields)
+{
+    if (timeline.truncated)
+        return;
+
+    auto t = (g_get_monotonic_time() - timeline.start) / 1000;
+    auto* line = g_strdup_printf("{\"t\":%" G_GINT64_FORMAT ",\"ev\":\"%s\"%s}\n",
+                                 t, event, fields ? fields : "");
+    if (timeline.size + static_cast<gint64>(strlen(line)) > telemetry->maxSize) {
+        // the rest of the call would push out every other timeline
+        g_free(line);
+        line = g_strdup_printf("{\"t\":%" G_GINT64_FORMAT ",\"ev\":\"truncated\"}\n", t);
+        timeline.truncated = true;
+    }
+    fputs(line, timeline.file);
+    fflush(timeline.file);
+    timeline.size += strlen(line);
+    g_free(line);
+}
+
+static Timeline*
+open_timeline(const QString& accountId, const QString& callId, bool audioOnly)
+{
+    auto* now = g_date_time_new_now_local();
+    auto* stamp = g_date_time_format(now, "%Y%m%d-%H%M%S");
+    auto* time = g_date_time_format(now, "%Y-%m-%dT%H:%M:%S%z");
+    g_date_time_unref(now);
+
+    auto id = callId.toStdString();
+    auto path = telemetry->dir + G_DIR_SEPARATOR_S + stamp + "-" + id + ".jsonl";
+    g_free(stamp);
+    auto* file = g_fopen(path.c_str(), "w");
+    if (!file) {
+        g_warning("could not record the call %s in %s", id.c_str(), path.c_str());
+        g_free(time);
+        return nullptr;
+    }
+
+    if (telemetry->timelines.empty() && !smart_info_displayed())
+        SmartInfoHub::instance().start();
+
+    auto& timeline = telemetry->timelines[id];
+    timeline = {file, path, g_get_monotonic_time(), 0, false, {}};
+
+    auto* json_time = json_string(time);
+    auto* json_account = json_string(qUtf8Printable(accountId));
+    auto* json_call = json_string(id.c_str());
+    auto* fields = g_strdup_printf(",\"time\":%s,\"account\":%s,\"call\":%s,\"audioOnly\":%s",
+                                   json_time, json_account, json_call,
+                                   audioOnly ? "true" : "false");
+    write_line(timeline, "call", fields);
+    g_free(fields);
+    g_free(json_call);
+    g_free(json_account);
+    g_free(json_time);
+    g_free(time);
+    return &timeline;
+}
+
+static void
+close_timeline(std::map<std::string, Timeline>::iterator it)
+{
+    fclose(it->second.file);
+    telemetry->timelines.erase(it);
+
+    if (telemetry->timelines.empty() && !smart_info_displayed())
+        SmartInfoHub::instance().stop();
+    rotate_timelines();
+}
+
+static void
+on_call_status_changed(const QString& accountId, const QString& callId)
+{
+    auto status = lrc::api::call::Status::ENDED;
+    auto audioOnly = false;
+    try {
+        auto& accountInfo = telemetry->lrc->getAccountModel().getAccountInfo(accountId);
+        auto call = accountInfo.callModel->getCall(callId);
+        status = call.status;
+        audioOnly = call.isAudioOnly;
+    } catch (const std::out_of_range&) {
+        // already removed
+    }
+
+    auto it = telemetry->timelines.find(callId.toStdString());
+    Timeline* timeline = it != telemetry->timelines.end() ? &it->second : nullptr;
+    if (!timeline) {
+        if (status == lrc::api::call::Status::ENDED || status == lrc::api::call::Status::INVALID)
+            return;
+        timeline = open_timeline(accountId, callId, audioOnly);
+        if (!timeline)
+            return;
+    }
+
+    auto* json_status = json_string(qUtf8Printable(lrc::api::call::to_string(status)));
+    auto* fields = g_strdup_printf(",\"status\":%s", json_status);
+    write_line(*timeline, "status", fields);
+    g_free(fields);
+    g_free(json_status);
+
+    if (status == lrc::api::call::Status::ENDED)
+        close_timeline(telemetry->timelines.find(callId.toStdString()));
+}
+
+static void
+on_smart_info_changed()
+{
+    auto now = g_get_monotonic_time();
+    if (now - telemetry->lastSample < SAMPLE_INTERVAL_US)
+        return;
+
+    auto& hub = SmartInfoHub::instance();
+    auto it = telemetry->timelines.find(hub.callID().toStdString());
+    if (it == telemetry->timelines.end())
+        return;
+    telemetry->lastSample = now;
+    auto& timeline = it->second;
+
+    auto codecs = (hub.localVideoCodec() + "/" + hub.localAudioCodec() + "/"
+                   + hub.remoteVideoCodec() + "/" + hub.remoteAudioCodec()).toStdString();
+    if (codecs != timeline.codecs) {
+        timeline.codecs = codecs;
+        auto* json_codecs = json_string(codecs.c_str());
+        auto* fields = g_strdup_printf(",\"codecs\":%s", json_codecs);
+        write_line(timeline, "codecs", fields);
+        g_free(fields);
+        g_free(json_codecs);
+    }
+
+    // not localized, the decimal separator must be a dot
+    gchar localFps[G_ASCII_DTOSTR_BUF_SIZE];
+    gchar remoteFps[G_ASCII_DTOSTR_BUF_SIZE];
+    g_ascii_formatd(localFps, sizeof(localFps), "%.1f", hub.localFps());
+    g_ascii_formatd(remoteFps, sizeof(remoteFps), "%.1f", hub.remoteFps());
+    auto* fields = g_strdup_printf(",\"fps\":[%s,%s],\"res\":[\"%dx%d\",\"%dx%d\"]",
+                                   localFps, remoteFps,
+                                   hub.localWidth(), hub.localHeight(),
+                                   hub.remoteWidth(), hub.remoteHeight());
+    write_line(timeline, "sample", fields);
+    g_free(fields);
+}
+
+void
+call_telemetry_enable(lrc::api::Lrc& lrc, gint64 max_size)
+{
+    if (telemetry) {
+        telemetry->maxSize = max_size;
+        return;
+    }
+
+    telemetry = new Telemetry;
+    telemetry->lrc = &lrc;
+    telemetry->dir = timelines_dir();
+    telemetry->maxSize = max_size;
+    if (g_mkdir_with_parents(telemetry->dir.c_str(), 0700) != 0)
+        g_warning("'%s' dir doesn't exist and could not be created", telemetry->dir.c_str());
+
+    telemetry->statusConnection = QObject::connect(&lrc.getBehaviorController(),
+                                                   &lrc::api::BehaviorController::callStatusChanged,
+                                                   on_call_status_changed);
+    telemetry->smartInfoConnection = QObject::connect(&SmartInfoHub::instance(),
+                                                      &SmartInfoHub::changed,
+                                                      on_smart_info_changed);
+    rotate_timelines();
+    g_debug("recording the calls in %s", telemetry->dir.c_str());
+}
+
+gboolean
+call_telemetry_enabled(void)
+{
+    return telemetry != nullptr;
+}
+
+void
+call_telemetry_disable(void)
+{
+    if (!telemetry)
+        return;
+
+    QObject::disconnect(telemetry->statusConnection);
+    QObject::disconnect(telemetry->smartInfoConnection);
+    while (!telemetry->timelines.empty())
+        close_timeline(telemetry->timelines.begin());
+
+    delete telemetry;
+    telemetry = nullptr;
+}
+
+gboolean
+call_telemetry_uses_smart_info(void)
+{
+    return telemetry && !telemetry->timelines.empty();
+}
+
+void
+call_telemetry_event(const gchar *call_id, const gchar *event, const gchar *detail)
+{
+    if (!telemetry)
+        return;
+    auto it = telemetry->timelines.find(call_id);
+    if (it == telemetry->timelines.end())
+        return;
+
+    if (!detail) {
+        write_line(it->second, event, nullptr);
+        return;
+    }
+    auto* json_detail = json_string(detail);
+    auto* fields = g_strdup_printf(",\"detail\":%s", json_detail);
+    write_line(it->second, event, fields);
+    g_free(fields);
+    g_free(json_detail);
+}
+
+static void
+write_duration(const gchar *call_id, const gchar *event, gint64 duration)
+{
+    if (!telemetry)
+        return;
+    auto it = telemetry->timelines.find(call_id);
+    if (it == telemetry->timelines.end())
+        return;
+
+    auto* fields = g_strdup_printf(",\"duration\":%" G_GINT64_FORMAT, duration / 1000);
+    write_line(it->second, event, fields);
+    g_free(fields);
+}
+
+void
+call_telemetry_mainloop_stall(const gchar *call_id, gint64 duration)
+{
+    write_duration(call_id, "mainloop-stall", duration);
+}
+
+void
+call_telemetry_video_frozen(const gchar *call_id, gint64 duration)
+{
+    write_duration(call_id, "frozen", duration);
+}
+
+static void
+print_time(gint64 t)
+{
+    t /= 1000;
+    g_print("+%02" G_GINT64_FORMAT ":%02" G_GINT64_FORMAT, t / 60, t % 60);
+}
+
+gboolean
+call_telemetry_print_summary(const gchar *path)
+{
+    std::string file;
+    if (path) {
+        file = path;
+    } else {
+        auto dir = timelines_dir();
+        auto names = list_timelines(dir);
+        if (names.empty()) {
+            g_printerr("no call recorded in %s\n", dir.c_str());
+            return FALSE;
+        }
+        file = dir + G_DIR_SEPARATOR_S + names.back();
+    }
+
+    gchar* contents;
+    gsize length;
+    GError* error = nullptr;
+    if (!g_file_get_contents(file.c_str(), &contents, &length, &error)) {
+        g_printerr("%s\n", error->message);
+        g_error_free(error);
+        return FALSE;
+    }
+    auto lines = QByteArray(contents, length).split('\n');
+    g_free(contents);
+
+    g_print("%s\n\n", file.c_str());
+    gint64 duration = 0;
+    guint samples = 0;
+    double localFps = 0, remoteFps = 0;
+    double minRemoteFps = G_MAXDOUBLE, maxRemoteFps = 0;
+    struct Pauses {
+        guint count = 0;
+        gint64 duration = 0;
+        gint64 longest = 0;
+    } stalls, freezes;
+
+    // everything but the samples, as it happened
+    for (const auto& line : lines) {
+        auto event = QJsonDocument::fromJson(line).object();
+        if (event.isEmpty())
+            continue;
+        auto t = static_cast<gint64>(event["t"].toDouble());
+        auto name = event["ev"].toString();
+        duration = std::max(duration, t);
+
+        if (name == "sample") {
+            auto fps = event["fps"].toArray();
+            ++samples;
+            localFps += fps[0].toDouble();
+            remoteFps += fps[1].toDouble();
+            minRemoteFps = std::min(minRemoteFps, fps[1].toDouble());
+            maxRemoteFps = std::max(maxRemoteFps, fps[1].toDouble());
+            continue;
+        }
+
+        print_time(t);
+        if (name == "call") {
+            g_print(" call %s of the account %s, started at %s%s\n",
+                    qUtf8Printable(event["call"].toString()),
+                    qUtf8Printable(event["account"].toString()),
+                    qUtf8Printable(event["time"].toString()),
+                    event["audioOnly"].toBool() ? ", audio only" : "");
+        } else if (name == "status") {
+            g_print(" %s\n", qUtf8Printable(event["status"].toString()));
+        } else if (name == "codecs") {
+            g_print(" codecs (yours/peer's video/audio): %s\n", qUtf8Printable(event["codecs"].toString()));
+        } else if (name == "mainloop-stall" || name == "frozen") {
+            auto pause = static_cast<gint64>(event["duration"].toDouble());
+            auto& pauses = name == "frozen" ? freezes : stalls;
+            ++pauses.count;
+            pauses.duration += pause;
+            pauses.longest = std::max(pauses.longest, pause);
+            g_print(name == "frozen" ? " no new frame from the peer for %" G_GINT64_FORMAT " ms\n"
+                                     : " main loop stalled for %" G_GINT64_FORMAT " ms\n",
+                    pause);
+        } else if (event.contains("detail")) {
+            g_print(" %s: %s\n", qUtf8Printable(name), qUtf8Printable(event["detail"].toString()));
+        } else {
+            g_print(" %s\n", qUtf8Printable(name));
+        }
+    }
+
+    g_print("\nduration: ");
+    print_time(duration);
+    g_print("\n");
+    if (samples) {
+        g_print("framerate: yours %.1f on average, the peer's %.1f (%.1f to %.1f), over %u samples\n",
+                localFps / samples, remoteFps / samples, minRemoteFps, maxRemoteFps, samples);
+    }
+    g_print("main loop stalls: %u, %" G_GINT64_FORMAT " ms in all, the longest %" G_GINT64_FORMAT " ms\n",
+            stalls.count, stalls.duration, stalls.longest);
+    g_print("video freezes: %u, %" G_GINT64_FORMAT " ms in all, the longest %" G_GINT64_FORMAT " ms\n",
+            freezes.count, freezes.duration, freezes.longest);
+    return TRUE;
+}
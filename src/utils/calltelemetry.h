@@ -0,0 +1,91 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef _CALLTELEMETRY_H
+#define _CALLTELEMETRY_H
+
+#include <glib.h>
+
+/**
+ * The timeline of every call, recorded when the user opted in: the changes of
+ * status, the samples and the codecs of the SmartInfo, the main loop stalls,
+ * the freezes of the video of the peer and the switches of the video input.
+ * Each call is written as JSON lines to its own file under
+ * $XDG_STATE_HOME/jami-gnome/calls, the oldest files being removed past a
+ * size limit.
+ *
+ * Every function recording an event is a no-op while the recorder is disabled,
+ * and for the calls without a timeline.
+ */
+
+G_BEGIN_DECLS
+
+gboolean call_telemetry_enabled(void);
+void     call_telemetry_disable(void);
+
+/**
+ * Whether the recorder uses the SmartInfoHub, which should then keep running.
+ */
+gboolean call_telemetry_uses_smart_info(void);
+
+/**
+ * `detail' may be NULL.
+ */
+void call_telemetry_event(const gchar *call_id, const gchar *event, const gchar *detail);
+/**
+ * The main loop was too busy to refresh the frames of `call_id' for
+ * `duration' microseconds.
+ */
+void call_telemetry_mainloop_stall(const gchar *call_id, gint64 duration);
+/**
+ * The peer of `call_id' sent no new frame for `duration' microseconds.
+ */
+void call_telemetry_video_frozen(const gchar *call_id, gint64 duration);
+
+/**
+ * Print a summary of the timeline at `path', or of the last one recorded if
+ * `path' is NULL. Returns FALSE if it could not be read.
+ */
+gboolean call_telemetry_print_summary(const gchar *path);
+
+/**
+ * `text' as a quoted JSON string, to free with g_free().
+ */
+gchar *json_string(const gchar *text);
+
+G_END_DECLS
+
+#ifdef __cplusplus
+
+namespace lrc
+{
+namespace api
+{
+    class Lrc;
+}
+}
+
+/**
+ * Record the calls of every account of `lrc', keeping at most `max_size' bytes
+ * of timelines.
+ */
+void call_telemetry_enable(lrc::api::Lrc& lrc, gint64 max_size);
+
+#endif
+
+#endif /* _CALLTELEMETRY_H */
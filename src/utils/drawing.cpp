@@ -430,6 +430,7 @@ GdkPixbuf *draw_generate_avatar(const std::string& alias,
     if (uri.length() > 0) {
         auto* md5 = g_compute_checksum_for_string(G_CHECKSUM_MD5, uri.c_str(), -1);
         color = std::string("0123456789abcdef").find(md5[0]);
+        g_free(md5);
     }
 
     return draw_fallback_avatar(FALLBACK_AVATAR_SIZE, letter, color);
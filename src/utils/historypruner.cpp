@@ -0,0 +1,168 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "historypruner.h"
+
+// std
+#include <ctime>
+#include <stdexcept>
+
+// LRC
+#include <api/account.h>
+#include <api/conversation.h>
+#include <api/conversationmodel.h>
+#include <api/lrc.h>
+#include <api/newaccountmodel.h>
+
+// Jami Client
+#include "files.h"
+#include "startuptracer.h"
+
+// leave the startup alone
+static constexpr guint STARTUP_DELAY_S = 15;
+// long lived sessions are pruned again this often
+static constexpr guint PRUNE_INTERVAL_S = 6 * 60 * 60;
+// after a change of the setting, in case the user is still typing
+static constexpr guint SETTING_DELAY_S = 5;
+// accounts pruned per idle iteration, deleteObsoleteHistory() can't be split
+static constexpr std::size_t ACCOUNTS_PER_IDLE = 1;
+
+HistoryPruner::HistoryPruner(lrc::api::Lrc& lrc)
+    : lrc_(lrc)
+{
+    settings_ = g_settings_new_full(get_settings_schema(), nullptr, nullptr);
+    limitChanged_ = g_signal_connect(settings_, "changed::history-limit",
+                                     G_CALLBACK(onLimitChanged), this);
+    schedule(STARTUP_DELAY_S);
+}
+
+HistoryPruner::~HistoryPruner()
+{
+    cancel();
+    if (scheduleSource_)
+        g_source_remove(scheduleSource_);
+    g_signal_handler_disconnect(settings_, limitChanged_);
+    g_clear_object(&settings_);
+}
+
+void
+HistoryPruner::schedule(guint delay)
+{
+    if (scheduleSource_)
+        g_source_remove(scheduleSource_);
+    scheduleSource_ = g_timeout_add_seconds_full(G_PRIORITY_LOW, delay, onScheduled, this, nullptr);
+}
+
+gboolean
+HistoryPruner::onScheduled(gpointer self)
+{
+    auto* pruner = static_cast<HistoryPruner*>(self);
+    pruner->scheduleSource_ = 0;
+    pruner->run();
+    pruner->schedule(PRUNE_INTERVAL_S);
+    return G_SOURCE_REMOVE;
+}
+
+void
+HistoryPruner::onLimitChanged(GSettings*, const gchar*, gpointer self)
+{
+    static_cast<HistoryPruner*>(self)->schedule(SETTING_DELAY_S);
+}
+
+void
+HistoryPruner::run()
+{
+    if (running())
+        return; // the accounts left will be pruned with the current limit anyway
+    if (g_settings_get_int(settings_, "history-limit") <= 0)
+        return; // unlimited history
+
+    pending_.clear();
+    for (const auto& accountId : lrc_.getAccountModel().getAccountList())
+        pending_.emplace_back(accountId);
+    if (pending_.empty())
+        return;
+
+    accounts_ = pending_.size();
+    removed_ = 0;
+    started_ = g_get_monotonic_time();
+    pruneSource_ = g_idle_add_full(G_PRIORITY_LOW, onIdle, this, nullptr);
+}
+
+void
+HistoryPruner::cancel()
+{
+    if (!running())
+        return;
+    g_source_remove(pruneSource_);
+    pruneSource_ = 0;
+    g_debug("history pruning cancelled, %zu/%zu accounts left",
+            pending_.size(), accounts_);
+    pending_.clear();
+}
+
+gboolean
+HistoryPruner::onIdle(gpointer self)
+{
+    auto* pruner = static_cast<HistoryPruner*>(self);
+    auto days = g_settings_get_int(pruner->settings_, "history-limit");
+
+    for (std::size_t i = 0; i < ACCOUNTS_PER_IDLE && !pruner->pending_.empty() && days > 0; ++i) {
+        auto accountId = pruner->pending_.back();
+        pruner->pending_.pop_back();
+        startup_tracer_begin("deleteObsoleteHistory");
+        pruner->pruneAccount(accountId, days);
+        startup_tracer_end("deleteObsoleteHistory");
+        g_debug("history pruning: %zu/%zu accounts done, %zu interactions removed",
+                pruner->accounts_ - pruner->pending_.size(), pruner->accounts_, pruner->removed_);
+    }
+    if (!pruner->pending_.empty() && days > 0)
+        return G_SOURCE_CONTINUE;
+
+    g_debug("history older than %d days pruned in %" G_GINT64_FORMAT " ms, %zu interactions removed",
+              days, (g_get_monotonic_time() - pruner->started_) / 1000, pruner->removed_);
+    pruner->pending_.clear();
+    pruner->pruneSource_ = 0;
+    return G_SOURCE_REMOVE;
+}
+
+void
+HistoryPruner::pruneAccount(const QString& accountId, int days)
+{
+    try {
+        const auto& accountInfo = lrc_.getAccountModel().getAccountInfo(accountId);
+        auto& conversationModel = *accountInfo.conversationModel;
+
+        // deleteObsoleteHistory() doesn't tell what it removed, count it in
+        // the loaded history. It only prunes the non swarm conversations.
+        auto limit = std::time(nullptr) - static_cast<std::time_t>(days) * 24 * 60 * 60;
+        for (const lrc::api::conversation::Info& conversation :
+                 conversationModel.getFilteredConversations(accountInfo.profileInfo.type).get()) {
+            if (conversation.isSwarm())
+                continue;
+            for (const auto& interaction : *conversation.interactions) {
+                if (interaction.second.timestamp <= limit)
+                    ++removed_;
+            }
+        }
+
+        conversationModel.deleteObsoleteHistory(days);
+    } catch (const std::out_of_range&) {
+        // the account was removed meanwhile
+    }
+}
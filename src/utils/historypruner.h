@@ -0,0 +1,85 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Qt
+#include <QString>
+
+// GLib
+#include <gio/gio.h>
+
+namespace lrc
+{
+namespace api
+{
+class Lrc;
+}
+}
+
+/**
+ * Deletes the history older than the "history-limit" setting.
+ *
+ * The pruning runs a while after startup, then periodically, and again when
+ * the setting changes. Accounts are pruned from a low priority idle source,
+ * one account per iteration, so the main loop gets a turn between accounts.
+ * Pruning a single account is not split, it is one synchronous LRC call.
+ * LRC databases can only be used from the main thread, so there is no worker
+ * thread here.
+ */
+class HistoryPruner
+{
+public:
+    explicit HistoryPruner(lrc::api::Lrc& lrc);
+    ~HistoryPruner();
+
+    /**
+     * Prune every account as soon as the main loop is idle.
+     */
+    void run();
+    void cancel();
+
+    bool running() const { return pruneSource_ != 0; }
+
+private:
+    HistoryPruner(const HistoryPruner&) = delete;
+    HistoryPruner& operator=(const HistoryPruner&) = delete;
+
+    void schedule(guint delay);
+    void pruneAccount(const QString& accountId, int days);
+
+    static gboolean onScheduled(gpointer self);
+    static gboolean onIdle(gpointer self);
+    static void onLimitChanged(GSettings* settings, const gchar* key, gpointer self);
+
+    lrc::api::Lrc& lrc_;
+    GSettings* settings_ {nullptr};
+    gulong limitChanged_ {0};
+
+    guint scheduleSource_ {0};
+    guint pruneSource_ {0};
+
+    // current run
+    std::vector<QString> pending_;
+    std::size_t accounts_ {0};
+    std::size_t removed_ {0};
+    gint64 started_ {0};
+};
@@ -0,0 +1,680 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "messageindex.h"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+// GLib
+#include <glib.h>
+#include <glib/gstdio.h>
+
+// LRC
+#include <api/account.h>
+#include <api/conversation.h>
+#include <api/conversationmodel.h>
+#include <api/interaction.h>
+
+static constexpr const char* INDEX_MAGIC = "JAMI-MESSAGE-INDEX";
+static constexpr int INDEX_VERSION = 1;
+static constexpr const char* INDEX_SUFFIX = ".idx";
+// longer words are most likely links or blobs, not worth indexing
+static constexpr std::size_t MAX_TERM_LENGTH = 64;
+// delay between a change and the index being written back
+static constexpr guint SAVE_DELAY_S = 30;
+
+/**
+ * Casefolded alphanumeric runs of text, in order of appearance.
+ */
+static std::vector<std::string>
+split_words(const std::string& text)
+{
+    std::vector<std::string> words;
+    if (text.empty() || !g_utf8_validate(text.c_str(), text.size(), nullptr))
+        return words;
+
+    auto* folded = g_utf8_casefold(text.c_str(), text.size());
+    std::string current;
+    for (auto* p = folded; *p; p = g_utf8_next_char(p)) {
+        auto c = g_utf8_get_char(p);
+        if (g_unichar_isalnum(c)) {
+            gchar buf[6];
+            current.append(buf, g_unichar_to_utf8(c, buf));
+        } else if (!current.empty()) {
+            if (current.size() <= MAX_TERM_LENGTH)
+                words.emplace_back(std::move(current));
+            current.clear();
+        }
+    }
+    if (!current.empty() && current.size() <= MAX_TERM_LENGTH)
+        words.emplace_back(std::move(current));
+    g_free(folded);
+    return words;
+}
+
+std::vector<std::string>
+MessageIndex::tokenize(const std::string& text)
+{
+    auto terms = split_words(text);
+    std::sort(terms.begin(), terms.end());
+    terms.erase(std::unique(terms.begin(), terms.end()), terms.end());
+    return terms;
+}
+
+std::string
+MessageIndex::directoryFor(const std::string& accountId)
+{
+    auto* dir = g_build_filename(g_get_user_cache_dir(), "jami-gnome", "index",
+                                 accountId.c_str(), nullptr);
+    std::string result = dir;
+    g_free(dir);
+    return result;
+}
+
+std::string
+MessageIndex::pathFor(const std::string& accountId, const std::string& convUid)
+{
+    auto* file = g_strconcat(convUid.c_str(), INDEX_SUFFIX, nullptr);
+    auto* path = g_build_filename(directoryFor(accountId).c_str(), file, nullptr);
+    std::string result = path;
+    g_free(path);
+    g_free(file);
+    return result;
+}
+
+bool
+MessageIndex::add(const std::string& interactionId,
+                  const std::string& body,
+                  std::time_t timestamp)
+{
+    if (byId_.find(interactionId) != byId_.end())
+        return false;
+
+    auto docId = static_cast<uint32_t>(docs_.size());
+    docs_.emplace_back(Document {interactionId, timestamp, false});
+    byId_.emplace(interactionId, docId);
+    lastActivity_ = std::max(lastActivity_, timestamp);
+    for (auto& term : tokenize(body))
+        postings_[term].push_back(docId);
+    dirty_ = true;
+    return true;
+}
+
+void
+MessageIndex::remove(const std::string& interactionId)
+{
+    auto it = byId_.find(interactionId);
+    if (it == byId_.end())
+        return;
+    docs_[it->second].removed = true;
+    byId_.erase(it);
+    dirty_ = true;
+}
+
+bool
+MessageIndex::contains(const std::string& interactionId) const
+{
+    return byId_.find(interactionId) != byId_.end();
+}
+
+std::vector<uint32_t>
+MessageIndex::matchTerm(const std::string& term, bool prefix) const
+{
+    if (!prefix) {
+        auto it = postings_.find(term);
+        return it == postings_.end() ? std::vector<uint32_t>() : it->second;
+    }
+
+    // concatenate then sort once, a short prefix can match thousands of terms
+    std::vector<uint32_t> result;
+    for (auto it = postings_.lower_bound(term);
+         it != postings_.end() && it->first.compare(0, term.size(), term) == 0;
+         ++it)
+        result.insert(result.end(), it->second.begin(), it->second.end());
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+std::vector<MessageIndex::Hit>
+MessageIndex::search(const std::string& query, std::size_t limit) const
+{
+    std::vector<Hit> result;
+
+    // keep the order of the query, only the word being typed is a prefix
+    auto words = split_words(query);
+    if (words.empty())
+        return result;
+
+    // start from the exact terms, they usually have the shortest lists
+    std::vector<std::vector<uint32_t>> lists;
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        auto docs = matchTerm(words[i], i == words.size() - 1);
+        if (docs.empty())
+            return result;
+        lists.emplace_back(std::move(docs));
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+                  return a.size() < b.size();
+              });
+
+    auto matches = std::move(lists.front());
+    for (auto it = std::next(lists.begin()); it != lists.end() && !matches.empty(); ++it) {
+        std::vector<uint32_t> intersection;
+        std::set_intersection(matches.begin(), matches.end(),
+                              it->begin(), it->end(),
+                              std::back_inserter(intersection));
+        matches.swap(intersection);
+    }
+
+    matches.erase(std::remove_if(matches.begin(), matches.end(),
+                                 [this](uint32_t docId) { return docs_[docId].removed; }),
+                  matches.end());
+    auto mostRecent = [this](uint32_t a, uint32_t b) {
+        return docs_[a].timestamp > docs_[b].timestamp;
+    };
+    if (matches.size() > limit) {
+        std::partial_sort(matches.begin(), matches.begin() + limit, matches.end(), mostRecent);
+        matches.resize(limit);
+    } else {
+        std::sort(matches.begin(), matches.end(), mostRecent);
+    }
+
+    result.reserve(matches.size());
+    for (auto docId : matches)
+        result.emplace_back(Hit {docs_[docId].interactionId, docs_[docId].timestamp});
+    return result;
+}
+
+/*
+ * Format, one record per line:
+ *   JAMI-MESSAGE-INDEX <version>
+ *   D <interactionId> <timestamp>        (document ids are implicit, in order)
+ *   T <term> <docId> <docId> ...
+ */
+std::string
+MessageIndex::serialize() const
+{
+    std::vector<uint32_t> remap(docs_.size(), UINT32_MAX);
+    std::ostringstream out;
+    out << INDEX_MAGIC << ' ' << INDEX_VERSION << '\n';
+
+    uint32_t next = 0;
+    for (std::size_t i = 0; i < docs_.size(); ++i) {
+        if (docs_[i].removed)
+            continue;
+        remap[i] = next++;
+        out << "D " << docs_[i].interactionId << ' '
+            << static_cast<long long>(docs_[i].timestamp) << '\n';
+    }
+
+    for (const auto& posting : postings_) {
+        std::ostringstream line;
+        bool empty = true;
+        for (auto docId : posting.second) {
+            if (remap[docId] == UINT32_MAX)
+                continue;
+            line << ' ' << remap[docId];
+            empty = false;
+        }
+        if (!empty)
+            out << "T " << posting.first << line.str() << '\n';
+    }
+    return out.str();
+}
+
+bool
+MessageIndex::deserialize(const std::string& data)
+{
+    docs_.clear();
+    byId_.clear();
+    postings_.clear();
+    lastActivity_ = 0;
+    dirty_ = false;
+
+    auto corrupted = [this] {
+        docs_.clear();
+        byId_.clear();
+        postings_.clear();
+        lastActivity_ = 0;
+        return false;
+    };
+
+    std::istringstream in(data);
+    std::string magic;
+    int version = 0;
+    if (!(in >> magic >> version) || magic != INDEX_MAGIC || version != INDEX_VERSION)
+        return false;
+
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        if (line.size() < 2)
+            continue;
+        std::istringstream record(line.substr(2));
+        if (line[0] == 'D') {
+            std::string interactionId;
+            long long timestamp = 0;
+            if (!(record >> interactionId >> timestamp))
+                return corrupted();
+            byId_.emplace(interactionId, static_cast<uint32_t>(docs_.size()));
+            lastActivity_ = std::max(lastActivity_, static_cast<std::time_t>(timestamp));
+            docs_.emplace_back(Document {interactionId, static_cast<std::time_t>(timestamp), false});
+        } else if (line[0] == 'T') {
+            std::string term;
+            if (!(record >> term))
+                return corrupted();
+            auto& docs = postings_[term];
+            uint32_t docId;
+            while (record >> docId) {
+                if (docId >= docs_.size())
+                    return corrupted();
+                docs.push_back(docId);
+            }
+        }
+    }
+    return true;
+}
+
+/* MessageIndexStore */
+
+static std::map<std::string, std::unique_ptr<MessageIndexStore>>&
+stores()
+{
+    static std::map<std::string, std::unique_ptr<MessageIndexStore>> stores;
+    return stores;
+}
+
+MessageIndexStore&
+MessageIndexStore::forAccount(const std::string& accountId)
+{
+    auto& store = stores()[accountId];
+    if (!store)
+        store.reset(new MessageIndexStore(accountId));
+    return *store;
+}
+
+void
+MessageIndexStore::release(const std::string& accountId)
+{
+    stores().erase(accountId);
+}
+
+void
+MessageIndexStore::releaseAll()
+{
+    stores().clear();
+}
+
+MessageIndexStore::MessageIndexStore(const std::string& accountId)
+    : accountId_(accountId)
+{}
+
+MessageIndexStore::~MessageIndexStore()
+{
+    detach();
+}
+
+struct MessageIndexStore::BuildJob
+{
+    std::string directory;
+    std::size_t documentLimit;
+    std::vector<Pending> history;
+
+    std::map<std::string, std::unique_ptr<MessageIndex>> indexes;
+    std::size_t documents {0};
+};
+
+void
+MessageIndexStore::attach(lrc::api::ConversationModel& model, std::size_t documentLimit)
+{
+    if (model_ == &model)
+        return;
+    detach();
+    model_ = &model;
+    documentLimit_ = documentLimit;
+
+    newInteractionConnection_ = QObject::connect(&model, &lrc::api::ConversationModel::newInteraction,
+        [this](const QString& uid, const QString& interactionId, const lrc::api::interaction::Info& interaction) {
+            add(uid.toStdString(), interactionId, interaction);
+        });
+    interactionRemovedConnection_ = QObject::connect(&model, &lrc::api::ConversationModel::interactionRemoved,
+        [this](const QString& uid, const QString& interactionId) {
+            remove(uid.toStdString(), interactionId);
+        });
+    newMessagesAvailableConnection_ = QObject::connect(&model, &lrc::api::ConversationModel::newMessagesAvailable,
+        [this](const QString&, const QString& uid) {
+            catchUp(uid.toStdString());
+        });
+
+    // Snapshot what LRC knows on the main thread, the worker only sees copies
+    auto* job = new BuildJob();
+    job->directory = MessageIndex::directoryFor(accountId_);
+    job->documentLimit = documentLimit_;
+    for (const lrc::api::conversation::Info& conversation : model.getFilteredConversations(model.owner.profileInfo.type).get()) {
+        auto convUid = conversation.uid.toStdString();
+        for (const auto& interaction : *conversation.interactions) {
+            if (interaction.second.type != lrc::api::interaction::Type::TEXT)
+                continue;
+            job->history.emplace_back(Pending {convUid, interaction.first, interaction.second.body,
+                                               interaction.second.timestamp, false});
+        }
+    }
+
+    cancellable_ = g_cancellable_new();
+    auto* task = g_task_new(nullptr, cancellable_, onBuilt, this);
+    g_task_set_task_data(task, job, [](gpointer data) { delete static_cast<BuildJob*>(data); });
+    g_task_set_priority(task, G_PRIORITY_LOW);
+    g_task_run_in_thread(task, buildThread);
+    g_object_unref(task);
+}
+
+void
+MessageIndexStore::buildThread(GTask* task,
+                               G_GNUC_UNUSED gpointer source,
+                               gpointer data,
+                               GCancellable* cancellable)
+{
+    auto* job = static_cast<BuildJob*>(data);
+
+    // load the most recently written indexes first, they are the ones kept
+    // when the limit is reached
+    std::vector<std::pair<time_t, std::string>> files;
+    if (auto* dir = g_dir_open(job->directory.c_str(), 0, nullptr)) {
+        while (auto* name = g_dir_read_name(dir)) {
+            if (!g_str_has_suffix(name, INDEX_SUFFIX))
+                continue;
+            auto* path = g_build_filename(job->directory.c_str(), name, nullptr);
+            GStatBuf st;
+            if (g_stat(path, &st) == 0)
+                files.emplace_back(st.st_mtime, path);
+            g_free(path);
+        }
+        g_dir_close(dir);
+    }
+    std::sort(files.begin(), files.end(), std::greater<std::pair<time_t, std::string>>());
+
+    for (const auto& file : files) {
+        if (g_cancellable_is_cancelled(cancellable) || job->documents >= job->documentLimit)
+            break;
+        gchar* contents = nullptr;
+        gsize length = 0;
+        if (!g_file_get_contents(file.second.c_str(), &contents, &length, nullptr))
+            continue;
+        auto index = std::make_unique<MessageIndex>();
+        if (index->deserialize(std::string(contents, length))) {
+            auto* basename = g_path_get_basename(file.second.c_str());
+            std::string convUid(basename, strlen(basename) - strlen(INDEX_SUFFIX));
+            g_free(basename);
+            job->documents += index->size();
+            job->indexes.emplace(std::move(convUid), std::move(index));
+        } else {
+            g_debug("discarding invalid message index %s", file.second.c_str());
+        }
+        g_free(contents);
+    }
+
+    // then index what is missing, most recent messages first
+    std::sort(job->history.begin(), job->history.end(),
+              [](const Pending& a, const Pending& b) { return a.timestamp > b.timestamp; });
+    for (const auto& entry : job->history) {
+        if (g_cancellable_is_cancelled(cancellable) || job->documents >= job->documentLimit)
+            break;
+        auto& index = job->indexes[entry.conversation];
+        if (!index)
+            index = std::make_unique<MessageIndex>();
+        if (index->add(entry.interactionId.toStdString(), entry.body.toStdString(), entry.timestamp))
+            ++job->documents;
+    }
+    job->history.clear();
+
+    g_task_return_boolean(task, TRUE);
+}
+
+void
+MessageIndexStore::onBuilt(G_GNUC_UNUSED GObject* source, GAsyncResult* result, gpointer data)
+{
+    // on cancellation the store may already be gone, don't touch it
+    if (!g_task_propagate_boolean(G_TASK(result), nullptr))
+        return;
+
+    auto* self = static_cast<MessageIndexStore*>(data);
+    auto* job = static_cast<BuildJob*>(g_task_get_task_data(G_TASK(result)));
+    g_clear_object(&self->cancellable_);
+
+    self->indexes_ = std::move(job->indexes);
+    self->documents_ = job->documents;
+    self->ready_ = true;
+
+    auto queued = std::move(self->queued_);
+    self->queued_.clear();
+    for (const auto& change : queued) {
+        auto& index = self->indexFor(change.conversation);
+        if (change.removed) {
+            if (index.contains(change.interactionId.toStdString())) {
+                index.remove(change.interactionId.toStdString());
+                --self->documents_;
+            }
+        } else if (index.add(change.interactionId.toStdString(), change.body.toStdString(), change.timestamp)) {
+            ++self->documents_;
+        }
+    }
+
+    g_debug("message index of %s ready: %zu messages", self->accountId_.c_str(), self->documents_);
+    self->scheduleSave();
+}
+
+void
+MessageIndexStore::detach()
+{
+    if (!model_)
+        return;
+
+    QObject::disconnect(newInteractionConnection_);
+    QObject::disconnect(interactionRemovedConnection_);
+    QObject::disconnect(newMessagesAvailableConnection_);
+    if (cancellable_) {
+        g_cancellable_cancel(cancellable_);
+        g_clear_object(&cancellable_);
+    }
+    if (saveSource_) {
+        g_source_remove(saveSource_);
+        saveSource_ = 0;
+    }
+    save(true);
+
+    model_ = nullptr;
+    ready_ = false;
+    indexes_.clear();
+    queued_.clear();
+    documents_ = 0;
+}
+
+void
+MessageIndexStore::add(const std::string& convUid,
+                       const QString& interactionId,
+                       const lrc::api::interaction::Info& interaction)
+{
+    if (interaction.type != lrc::api::interaction::Type::TEXT || interaction.body.isEmpty())
+        return;
+    if (!ready_) {
+        queued_.emplace_back(Pending {convUid, interactionId, interaction.body, interaction.timestamp, false});
+        return;
+    }
+
+    if (indexFor(convUid).add(interactionId.toStdString(), interaction.body.toStdString(), interaction.timestamp)) {
+        ++documents_;
+        scheduleSave();
+    }
+}
+
+void
+MessageIndexStore::remove(const std::string& convUid, const QString& interactionId)
+{
+    if (!ready_) {
+        queued_.emplace_back(Pending {convUid, interactionId, {}, 0, true});
+        return;
+    }
+    auto it = indexes_.find(convUid);
+    if (it == indexes_.end() || !it->second->contains(interactionId.toStdString()))
+        return;
+    it->second->remove(interactionId.toStdString());
+    --documents_;
+    scheduleSave();
+}
+
+void
+MessageIndexStore::catchUp(const std::string& convUid)
+{
+    if (!model_)
+        return;
+    auto convOpt = model_->getConversationForUid(QString::fromStdString(convUid));
+    if (!convOpt)
+        return;
+    for (const auto& interaction : *convOpt->get().interactions)
+        add(convUid, interaction.first, interaction.second);
+}
+
+MessageIndex&
+MessageIndexStore::indexFor(const std::string& convUid)
+{
+    // make room the same way the load path does: the least recently active
+    // conversations go first, never the one receiving the message
+    while (documents_ >= documentLimit_) {
+        auto oldest = indexes_.end();
+        for (auto it = indexes_.begin(); it != indexes_.end(); ++it) {
+            if (it->first == convUid)
+                continue;
+            if (oldest == indexes_.end() || it->second->lastActivity() < oldest->second->lastActivity())
+                oldest = it;
+        }
+        if (oldest == indexes_.end())
+            break;
+        // unsaved changes are lost, the next catch up indexes them again
+        documents_ -= oldest->second->size();
+        indexes_.erase(oldest);
+    }
+
+    auto& index = indexes_[convUid];
+    if (!index)
+        index = std::make_unique<MessageIndex>();
+    return *index;
+}
+
+std::vector<MessageIndexStore::Hit>
+MessageIndexStore::search(const std::string& query, std::size_t limit) const
+{
+    std::vector<Hit> result;
+    auto mostRecent = [](const Hit& a, const Hit& b) { return a.timestamp > b.timestamp; };
+
+    // every conversation returns its own top hits, keep the overall top
+    for (const auto& index : indexes_) {
+        for (auto& hit : index.second->search(query, limit))
+            result.emplace_back(Hit {index.first, std::move(hit.interactionId), hit.timestamp});
+        if (result.size() > 2 * limit) {
+            std::nth_element(result.begin(), result.begin() + limit, result.end(), mostRecent);
+            result.resize(limit);
+        }
+    }
+    if (result.size() > limit) {
+        std::partial_sort(result.begin(), result.begin() + limit, result.end(), mostRecent);
+        result.resize(limit);
+    } else {
+        std::sort(result.begin(), result.end(), mostRecent);
+    }
+    return result;
+}
+
+std::vector<std::string>
+MessageIndexStore::searchConversation(const std::string& convUid, const std::string& query) const
+{
+    std::vector<std::string> result;
+    auto it = indexes_.find(convUid);
+    if (it == indexes_.end())
+        return result;
+    for (auto& hit : it->second->search(query))
+        result.emplace_back(std::move(hit.interactionId));
+    return result;
+}
+
+void
+MessageIndexStore::scheduleSave()
+{
+    if (saveSource_)
+        return;
+    saveSource_ = g_timeout_add_seconds_full(G_PRIORITY_LOW, SAVE_DELAY_S,
+        [](gpointer data) -> gboolean {
+            auto* self = static_cast<MessageIndexStore*>(data);
+            self->saveSource_ = 0;
+            self->save(false);
+            return G_SOURCE_REMOVE;
+        }, this, nullptr);
+}
+
+void
+MessageIndexStore::save(bool sync)
+{
+    if (!ready_)
+        return;
+
+    auto directory = MessageIndex::directoryFor(accountId_);
+    if (g_mkdir_with_parents(directory.c_str(), 0700) != 0) {
+        g_warning("'%s' dir doesn't exist and could not be created", directory.c_str());
+        return;
+    }
+
+    for (auto& index : indexes_) {
+        if (!index.second->dirty())
+            continue;
+        auto path = MessageIndex::pathFor(accountId_, index.first);
+        auto* data = new std::string(index.second->serialize());
+        index.second->markSaved();
+
+        if (sync) {
+            GError* error = nullptr;
+            if (!g_file_set_contents(path.c_str(), data->data(), data->size(), &error)) {
+                g_warning("could not save message index: %s", error->message);
+                g_clear_error(&error);
+            }
+            delete data;
+            continue;
+        }
+
+        auto* bytes = g_bytes_new_with_free_func(data->data(), data->size(),
+            [](gpointer data) { delete static_cast<std::string*>(data); }, data);
+        auto* file = g_file_new_for_path(path.c_str());
+        g_file_replace_contents_bytes_async(file, bytes, nullptr, FALSE,
+            G_FILE_CREATE_PRIVATE, nullptr,
+            [](GObject* file, GAsyncResult* result, gpointer) {
+                GError* error = nullptr;
+                if (!g_file_replace_contents_finish(G_FILE(file), result, nullptr, &error)) {
+                    g_warning("could not save message index: %s", error->message);
+                    g_clear_error(&error);
+                }
+            }, nullptr);
+        g_object_unref(file);
+        g_bytes_unref(bytes);
+    }
+}
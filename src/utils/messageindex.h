@@ -0,0 +1,222 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Qt
+#include <QMetaObject>
+#include <QString>
+
+// GLib
+#include <gio/gio.h>
+
+namespace lrc
+{
+namespace api
+{
+class ConversationModel;
+namespace interaction
+{
+    struct Info;
+}
+}
+}
+
+/**
+ * Inverted index over the text interactions of one conversation.
+ *
+ * Documents are appended with increasing ids, so every posting list stays
+ * sorted without any extra work and queries are a merge of sorted lists.
+ * Removed interactions are tombstoned and dropped when the index is saved.
+ */
+class MessageIndex
+{
+public:
+    struct Hit {
+        std::string interactionId;
+        std::time_t timestamp;
+    };
+
+    MessageIndex() = default;
+
+    /**
+     * Index the body of an interaction. Adding an interaction which is
+     * already indexed is a no-op, so callers can feed a whole history to
+     * catch up with messages received while the index was not loaded.
+     */
+    bool add(const std::string& interactionId,
+             const std::string& body,
+             std::time_t timestamp);
+    void remove(const std::string& interactionId);
+    bool contains(const std::string& interactionId) const;
+
+    /**
+     * @return the interactions containing every word of query, the last word
+     * being matched as a prefix. Most recent interactions first, at most limit.
+     */
+    std::vector<Hit> search(const std::string& query,
+                            std::size_t limit = std::numeric_limits<std::size_t>::max()) const;
+
+    std::size_t size() const { return byId_.size(); }
+    /**
+     * @return timestamp of the most recent indexed interaction.
+     */
+    std::time_t lastActivity() const { return lastActivity_; }
+    bool dirty() const { return dirty_; }
+    void markSaved() { dirty_ = false; }
+
+    /**
+     * Serialize the live documents. Tombstones are compacted away, document
+     * ids are renumbered in the process.
+     */
+    std::string serialize() const;
+    /**
+     * @return false if data is not a valid index, in which case the index is
+     * left empty and will be rebuilt from the conversation.
+     */
+    bool deserialize(const std::string& data);
+
+    /**
+     * Split text in casefolded words, as stored in the index.
+     */
+    static std::vector<std::string> tokenize(const std::string& text);
+
+    /**
+     * @return $XDG_CACHE_HOME/jami-gnome/index/<accountId>
+     */
+    static std::string directoryFor(const std::string& accountId);
+    /**
+     * @return $XDG_CACHE_HOME/jami-gnome/index/<accountId>/<convUid>.idx
+     */
+    static std::string pathFor(const std::string& accountId,
+                               const std::string& convUid);
+
+private:
+    struct Document {
+        std::string interactionId;
+        std::time_t timestamp;
+        bool removed;
+    };
+
+    std::vector<uint32_t> matchTerm(const std::string& term, bool prefix) const;
+
+    std::vector<Document> docs_;
+    std::unordered_map<std::string, uint32_t> byId_;
+    // ordered, so prefixes are a contiguous range
+    std::map<std::string, std::vector<uint32_t>> postings_;
+    std::time_t lastActivity_ {0};
+    bool dirty_ {false};
+};
+
+/**
+ * The message indexes of every conversation of an account.
+ *
+ * Once attached to a conversation model, the persisted indexes are loaded
+ * and caught up with the history known by LRC in a low priority worker
+ * thread. The store is then kept up to date from the model signals, on the
+ * main thread, and saved in the background a while after it changed.
+ *
+ * The number of indexed messages is capped: the indexes of the least
+ * recently active conversations are not loaded past the limit, and are
+ * dropped from memory when new messages would exceed it.
+ */
+class MessageIndexStore
+{
+public:
+    struct Hit {
+        std::string conversation;
+        std::string interactionId;
+        std::time_t timestamp;
+    };
+
+    static MessageIndexStore& forAccount(const std::string& accountId);
+    /**
+     * Detach and save the store of an account, then free it.
+     */
+    static void release(const std::string& accountId);
+    static void releaseAll();
+
+    void attach(lrc::api::ConversationModel& model, std::size_t documentLimit);
+    bool ready() const { return ready_; }
+    std::size_t documentCount() const { return documents_; }
+
+    /**
+     * Cross conversation search.
+     * @return the limit most recent matches.
+     */
+    std::vector<Hit> search(const std::string& query, std::size_t limit) const;
+    /**
+     * @return ids of the matching interactions of a conversation, most
+     * recent first.
+     */
+    std::vector<std::string> searchConversation(const std::string& convUid,
+                                                const std::string& query) const;
+
+    ~MessageIndexStore();
+
+private:
+    explicit MessageIndexStore(const std::string& accountId);
+
+    struct Pending {
+        std::string conversation;
+        QString interactionId;
+        QString body; // implicitly shared, cheap to hand to the worker
+        std::time_t timestamp;
+        bool removed;
+    };
+    struct BuildJob;
+
+    void add(const std::string& convUid,
+             const QString& interactionId,
+             const lrc::api::interaction::Info& interaction);
+    void remove(const std::string& convUid, const QString& interactionId);
+    void catchUp(const std::string& convUid);
+    MessageIndex& indexFor(const std::string& convUid);
+    void detach();
+    void save(bool sync);
+    void scheduleSave();
+
+    static void buildThread(GTask* task, gpointer source, gpointer data, GCancellable* cancellable);
+    static void onBuilt(GObject* source, GAsyncResult* result, gpointer self);
+
+    std::string accountId_;
+    lrc::api::ConversationModel* model_ {nullptr};
+    std::size_t documentLimit_ {0};
+    std::size_t documents_ {0};
+    bool ready_ {false};
+
+    std::map<std::string, std::unique_ptr<MessageIndex>> indexes_;
+    // changes received while the worker builds the indexes
+    std::vector<Pending> queued_;
+
+    GCancellable* cancellable_ {nullptr};
+    guint saveSource_ {0};
+
+    QMetaObject::Connection newInteractionConnection_;
+    QMetaObject::Connection interactionRemovedConnection_;
+    QMetaObject::Connection newMessagesAvailableConnection_;
+};
@@ -0,0 +1,192 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "startuptracer.h"
+
+#include <string>
+#include <vector>
+
+#include <unistd.h> // for getpid
+
+/* the main loop is probed this often... */
+static constexpr guint STALL_PROBE_MS = 10;
+/* ...and an iteration late by more than this is recorded as a stall */
+static constexpr gint64 STALL_THRESHOLD_US = 50 * 1000;
+/* how long after the tracer is enabled the main loop is probed */
+static constexpr gint64 STALL_WINDOW_US = 60 * G_USEC_PER_SEC;
+/* the startup is over once all of these were marked */
+static const gchar* const STARTUP_MILESTONES[] = {"first frame", "conversations loaded"};
+
+namespace {
+
+struct Event {
+    const gchar* name;
+    char phase; // 'B'egin, 'E'nd, 'X' complete or 'i'nstant, as in the trace event format
+    gint64 timestamp;
+    gint64 duration;
+};
+
+struct Tracer {
+    std::string path;
+    std::vector<Event> events;
+    gint64 start {0};
+    gint64 lastProbe {0};
+    guint probeSource {0};
+    std::vector<const gchar*> openPhases;
+    guint milestones {0}; // bit i is set once STARTUP_MILESTONES[i] is marked
+};
+
+Tracer* tracer = nullptr;
+
+} // namespace
+
+static gboolean
+probe_main_loop(G_GNUC_UNUSED gpointer data)
+{
+    auto now = g_get_monotonic_time();
+    auto late = now - tracer->lastProbe - STALL_PROBE_MS * 1000;
+    if (late > STALL_THRESHOLD_US)
+        tracer->events.push_back({"main loop stall", 'X', now - late, late});
+    tracer->lastProbe = now;
+
+    if (now - tracer->start > STALL_WINDOW_US) {
+        tracer->probeSource = 0;
+        startup_tracer_write();
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+static bool
+startup_over()
+{
+    return tracer->milestones == (1u << G_N_ELEMENTS(STARTUP_MILESTONES)) - 1;
+}
+
+/* the phases begun during the startup are still closed before writing */
+static void
+write_if_startup_over()
+{
+    if (startup_over() && tracer->openPhases.empty())
+        startup_tracer_write();
+}
+
+void
+startup_tracer_enable(const gchar *path)
+{
+    if (tracer)
+        return;
+
+    tracer = new Tracer;
+    if (path && *path) {
+        tracer->path = path;
+    } else {
+        auto* default_path = g_build_filename(g_get_user_cache_dir(), "jami-gnome",
+                                              "startup-trace.json", nullptr);
+        tracer->path = default_path;
+        g_free(default_path);
+    }
+    tracer->events.reserve(256);
+    tracer->start = tracer->lastProbe = g_get_monotonic_time();
+    tracer->probeSource = g_timeout_add_full(G_PRIORITY_HIGH, STALL_PROBE_MS,
+                                             probe_main_loop, nullptr, nullptr);
+    startup_tracer_mark("tracer enabled");
+}
+
+gboolean
+startup_tracer_enabled(void)
+{
+    return tracer != nullptr;
+}
+
+void
+startup_tracer_begin(const gchar *name)
+{
+    if (!tracer || startup_over())
+        return;
+    tracer->events.push_back({name, 'B', g_get_monotonic_time(), 0});
+    tracer->openPhases.push_back(name);
+}
+
+void
+startup_tracer_end(const gchar *name)
+{
+    /* ignore the end of the phases begun once the startup was over */
+    if (!tracer || tracer->openPhases.empty() || g_strcmp0(tracer->openPhases.back(), name) != 0)
+        return;
+    tracer->events.push_back({name, 'E', g_get_monotonic_time(), 0});
+    tracer->openPhases.pop_back();
+    write_if_startup_over();
+}
+
+void
+startup_tracer_mark(const gchar *name)
+{
+    if (!tracer || startup_over())
+        return;
+    tracer->events.push_back({name, 'i', g_get_monotonic_time(), 0});
+
+    for (guint i = 0; i < G_N_ELEMENTS(STARTUP_MILESTONES); ++i) {
+        if (g_strcmp0(STARTUP_MILESTONES[i], name) == 0)
+            tracer->milestones |= 1u << i;
+    }
+    write_if_startup_over();
+}
+
+void
+startup_tracer_write(void)
+{
+    if (!tracer)
+        return;
+
+    if (tracer->probeSource)
+        g_source_remove(tracer->probeSource);
+
+    auto pid = static_cast<int>(getpid());
+    GString* json = g_string_new("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (auto it = tracer->events.begin(); it != tracer->events.end(); ++it) {
+        auto* name = g_strescape(it->name, nullptr);
+        g_string_append_printf(json,
+                               "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%" G_GINT64_FORMAT ",\"pid\":%d,\"tid\":%d",
+                               it == tracer->events.begin() ? "" : ",",
+                               name, it->phase, it->timestamp - tracer->start, pid, pid);
+        if (it->phase == 'X')
+            g_string_append_printf(json, ",\"dur\":%" G_GINT64_FORMAT, it->duration);
+        else if (it->phase == 'i')
+            g_string_append(json, ",\"s\":\"p\"");
+        g_string_append_c(json, '}');
+        g_free(name);
+    }
+    g_string_append(json, "\n]}\n");
+
+    GError* error = nullptr;
+    auto* dir = g_path_get_dirname(tracer->path.c_str());
+    if (g_mkdir_with_parents(dir, 0700) != 0) {
+        g_warning("'%s' dir doesn't exist and could not be created", dir);
+    } else if (!g_file_set_contents(tracer->path.c_str(), json->str, json->len, &error)) {
+        g_warning("could not write the startup trace: %s", error->message);
+        g_error_free(error);
+    } else {
+        g_message("startup trace written to %s", tracer->path.c_str());
+    }
+    g_free(dir);
+    g_string_free(json, TRUE);
+
+    delete tracer;
+    tracer = nullptr;
+}
@@ -0,0 +1,57 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef _STARTUPTRACER_H
+#define _STARTUPTRACER_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * Start recording the startup phases, and the main loop stalls of the first
+ * seconds of the session. Recording stops once the first frame is drawn and
+ * the conversations are loaded, or after a minute at most. The trace is then
+ * written to `path' in the Chrome trace event format (chrome://tracing,
+ * https://ui.perfetto.dev), or to
+ * $XDG_CACHE_HOME/jami-gnome/startup-trace.json if `path' is NULL.
+ *
+ * Every other function is a no-op until this one is called, and once the
+ * trace is written.
+ */
+void startup_tracer_enable(const gchar *path);
+gboolean startup_tracer_enabled(void);
+
+/**
+ * Phases must be properly nested, `name' must be a static string.
+ */
+void startup_tracer_begin(const gchar *name);
+void startup_tracer_end(const gchar *name);
+/**
+ * Record a point in time, like the first frame drawn.
+ */
+void startup_tracer_mark(const gchar *name);
+
+/**
+ * Write the trace now if it was not yet, e.g. when quitting during startup.
+ */
+void startup_tracer_write(void);
+
+G_END_DECLS
+
+#endif /* _STARTUPTRACER_H */
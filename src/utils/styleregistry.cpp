@@ -0,0 +1,84 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "styleregistry.h"
+
+#include <unordered_map>
+
+namespace {
+
+struct Stylesheet {
+    GtkCssProvider* provider;
+    std::string css; // empty for the resources
+};
+
+// by resource path or name
+std::unordered_map<std::string, Stylesheet> stylesheets;
+
+} // namespace
+
+static GdkScreen *
+default_screen()
+{
+    return gdk_display_get_default_screen(gdk_display_get_default());
+}
+
+static void
+install(const std::string& key, GtkCssProvider* provider, const std::string& css)
+{
+    gtk_style_context_add_provider_for_screen(default_screen(),
+                                              GTK_STYLE_PROVIDER(provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    stylesheets[key] = {provider, css};
+    g_debug("stylesheet %s installed, %zu providers", key.c_str(), stylesheets.size());
+}
+
+void
+style_registry_load(const char *path)
+{
+    if (stylesheets.find(path) != stylesheets.end())
+        return;
+
+    auto* provider = gtk_css_provider_new();
+    gtk_css_provider_load_from_resource(provider, path);
+    install(path, provider, {});
+}
+
+void
+style_registry_set(const std::string& name, const std::string& css)
+{
+    auto it = stylesheets.find(name);
+    if (it != stylesheets.end()) {
+        if (it->second.css == css)
+            return;
+        gtk_style_context_remove_provider_for_screen(default_screen(),
+                                                     GTK_STYLE_PROVIDER(it->second.provider));
+        g_object_unref(it->second.provider);
+        stylesheets.erase(it);
+    }
+
+    auto* provider = gtk_css_provider_new();
+    gtk_css_provider_load_from_data(provider, css.c_str(), -1, nullptr);
+    install(name, provider, css);
+}
+
+guint
+style_registry_count(void)
+{
+    return stylesheets.size();
+}
@@ -0,0 +1,51 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef _STYLEREGISTRY_H
+#define _STYLEREGISTRY_H
+
+#include <gtk/gtk.h>
+
+#include <string>
+
+G_BEGIN_DECLS
+
+/**
+ * The stylesheets of the application, each installed once for the whole
+ * screen: every provider added to the screen is searched by every style
+ * lookup, for the rest of the session.
+ */
+
+/**
+ * Install the stylesheet of the resource `path', the first time only.
+ */
+void  style_registry_load(const char *path);
+/**
+ * Install the stylesheet `css' generated under `name', like the theme
+ * dependent ones. It replaces the one installed before under this name, if
+ * it differs.
+ */
+void  style_registry_set(const std::string& name, const std::string& css);
+/**
+ * The number of providers installed.
+ */
+guint style_registry_count(void);
+
+G_END_DECLS
+
+#endif /* _STYLEREGISTRY_H */
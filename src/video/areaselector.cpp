@@ -0,0 +1,251 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "areaselector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct Selection
+{
+    AreaSelectedCallback callback;
+    gpointer user_data;
+    GdkRectangle bounds; // of all the monitors
+    cairo_surface_t* background; // the screen, when it can't be seen through
+    bool pressed;
+    bool done;
+    gdouble startX, startY, x, y;
+};
+
+} // namespace
+
+static GdkRectangle
+selected_rectangle(const Selection* selection)
+{
+    GdkRectangle area;
+    area.x = static_cast<gint>(std::min(selection->startX, selection->x));
+    area.y = static_cast<gint>(std::min(selection->startY, selection->y));
+    area.width = static_cast<gint>(std::abs(selection->x - selection->startX));
+    area.height = static_cast<gint>(std::abs(selection->y - selection->startY));
+    return area;
+}
+
+static void
+scale_area(GdkRectangle* area, gint scale)
+{
+    area->x *= scale;
+    area->y *= scale;
+    area->width *= scale;
+    area->height *= scale;
+}
+
+static void
+free_selection(Selection* selection)
+{
+    if (!selection->done)
+        selection->callback(nullptr, selection->user_data);
+    if (selection->background)
+        cairo_surface_destroy(selection->background);
+    delete selection;
+}
+
+static void
+finish_selection(GtkWidget* window, Selection* selection, const GdkRectangle* area)
+{
+    if (selection->done)
+        return;
+    selection->done = true;
+    gdk_seat_ungrab(gdk_display_get_default_seat(gtk_widget_get_display(window)));
+    selection->callback(area, selection->user_data);
+    gtk_widget_destroy(window);
+}
+
+static gboolean
+on_map(GtkWidget* window, G_GNUC_UNUSED GdkEvent* event, Selection* selection)
+{
+    auto* display = gtk_widget_get_display(window);
+    auto* cursor = gdk_cursor_new_from_name(display, "crosshair");
+    auto status = gdk_seat_grab(gdk_display_get_default_seat(display),
+                                gtk_widget_get_window(window),
+                                GDK_SEAT_CAPABILITY_ALL, TRUE, cursor,
+                                nullptr, nullptr, nullptr);
+    if (cursor)
+        g_object_unref(cursor);
+    if (status != GDK_GRAB_SUCCESS) {
+        g_warning("couldn't grab the pointer to select a screen area: %d", status);
+        finish_selection(window, selection, nullptr);
+    }
+    return GDK_EVENT_PROPAGATE;
+}
+
+static gboolean
+on_draw(G_GNUC_UNUSED GtkWidget* window, cairo_t* cr, Selection* selection)
+{
+    cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+    if (selection->background) {
+        cairo_set_source_surface(cr, selection->background, 0, 0);
+        cairo_paint(cr);
+    } else {
+        cairo_set_source_rgba(cr, 0, 0, 0, 0.3);
+        cairo_paint(cr);
+    }
+
+    if (!selection->pressed)
+        return TRUE;
+
+    auto area = selected_rectangle(selection);
+    if (!selection->background) {
+        // the area shows the screen through
+        cairo_set_source_rgba(cr, 0, 0, 0, 0);
+        cairo_rectangle(cr, area.x, area.y, area.width, area.height);
+        cairo_fill(cr);
+    }
+    cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+    cairo_set_source_rgb(cr, 0.23, 0.75, 0.85);
+    cairo_set_line_width(cr, 1);
+    cairo_rectangle(cr, area.x + 0.5, area.y + 0.5, area.width, area.height);
+    cairo_stroke(cr);
+    return TRUE;
+}
+
+static gboolean
+on_button_press(GtkWidget* window, GdkEventButton* event, Selection* selection)
+{
+    if (event->button != GDK_BUTTON_PRIMARY) {
+        finish_selection(window, selection, nullptr);
+        return GDK_EVENT_STOP;
+    }
+    selection->pressed = true;
+    selection->startX = selection->x = event->x;
+    selection->startY = selection->y = event->y;
+    gtk_widget_queue_draw(window);
+    return GDK_EVENT_STOP;
+}
+
+static gboolean
+on_motion(GtkWidget* window, GdkEventMotion* event, Selection* selection)
+{
+    if (!selection->pressed)
+        return GDK_EVENT_STOP;
+    selection->x = event->x;
+    selection->y = event->y;
+    gtk_widget_queue_draw(window);
+    return GDK_EVENT_STOP;
+}
+
+static gboolean
+on_button_release(GtkWidget* window, GdkEventButton* event, Selection* selection)
+{
+    if (!selection->pressed || event->button != GDK_BUTTON_PRIMARY)
+        return GDK_EVENT_STOP;
+    selection->x = event->x;
+    selection->y = event->y;
+
+    auto area = selected_rectangle(selection);
+    if (area.width == 0 || area.height == 0) {
+        // a click selects its monitor
+        auto* monitor = gdk_display_get_monitor_at_point(gtk_widget_get_display(window),
+                                                         selection->bounds.x + static_cast<int>(event->x),
+                                                         selection->bounds.y + static_cast<int>(event->y));
+        gdk_monitor_get_geometry(monitor, &area);
+    } else {
+        area.x += selection->bounds.x;
+        area.y += selection->bounds.y;
+    }
+    scale_area(&area, gtk_widget_get_scale_factor(window));
+    finish_selection(window, selection, &area);
+    return GDK_EVENT_STOP;
+}
+
+static gboolean
+on_key_press(GtkWidget* window, GdkEventKey* event, Selection* selection)
+{
+    if (event->keyval == GDK_KEY_Escape)
+        finish_selection(window, selection, nullptr);
+    return GDK_EVENT_STOP;
+}
+
+void
+area_selector_select(GtkWidget *widget, AreaSelectedCallback callback, gpointer user_data)
+{
+    auto* screen = gtk_widget_get_screen(widget);
+    auto* display = gdk_screen_get_display(screen);
+
+    auto* selection = new Selection {callback, user_data, {0, 0, 0, 0}, nullptr, false, false, 0, 0, 0, 0};
+    for (int i = 0; i < gdk_display_get_n_monitors(display); ++i) {
+        GdkRectangle geometry;
+        gdk_monitor_get_geometry(gdk_display_get_monitor(display, i), &geometry);
+        if (i == 0)
+            selection->bounds = geometry;
+        else
+            gdk_rectangle_union(&selection->bounds, &geometry, &selection->bounds);
+    }
+
+    auto* window = gtk_window_new(GTK_WINDOW_POPUP);
+    gtk_window_set_screen(GTK_WINDOW(window), screen);
+    gtk_widget_set_app_paintable(window, TRUE);
+    auto* visual = gdk_screen_get_rgba_visual(screen);
+    if (visual && gdk_screen_is_composited(screen)) {
+        gtk_widget_set_visual(window, visual);
+    } else {
+        // nothing to see through, the screen is painted under the selection
+        const auto& bounds = selection->bounds;
+        if (auto* pixbuf = gdk_pixbuf_get_from_window(gdk_screen_get_root_window(screen),
+                                                      bounds.x, bounds.y,
+                                                      bounds.width, bounds.height)) {
+            selection->background = gdk_cairo_surface_create_from_pixbuf(pixbuf,
+                                                                         gtk_widget_get_scale_factor(widget),
+                                                                         nullptr);
+            g_object_unref(pixbuf);
+        }
+    }
+    gtk_window_move(GTK_WINDOW(window), selection->bounds.x, selection->bounds.y);
+    gtk_window_resize(GTK_WINDOW(window), selection->bounds.width, selection->bounds.height);
+    gtk_widget_add_events(window, GDK_BUTTON_PRESS_MASK | GDK_BUTTON_RELEASE_MASK
+                                  | GDK_POINTER_MOTION_MASK | GDK_KEY_PRESS_MASK);
+
+    g_object_set_data_full(G_OBJECT(window), "selection", selection, (GDestroyNotify)free_selection);
+    g_signal_connect(window, "map-event", G_CALLBACK(on_map), selection);
+    g_signal_connect(window, "draw", G_CALLBACK(on_draw), selection);
+    g_signal_connect(window, "button-press-event", G_CALLBACK(on_button_press), selection);
+    g_signal_connect(window, "motion-notify-event", G_CALLBACK(on_motion), selection);
+    g_signal_connect(window, "button-release-event", G_CALLBACK(on_button_release), selection);
+    g_signal_connect(window, "key-press-event", G_CALLBACK(on_key_press), selection);
+    gtk_widget_show(window);
+}
+
+void
+area_selector_get_monitor_area(GtkWidget *widget, GdkRectangle *area)
+{
+    auto* display = gtk_widget_get_display(widget);
+    GdkMonitor* monitor = nullptr;
+    if (auto* window = gtk_widget_get_window(widget))
+        monitor = gdk_display_get_monitor_at_window(display, window);
+    if (!monitor)
+        monitor = gdk_display_get_primary_monitor(display);
+    if (!monitor)
+        monitor = gdk_display_get_monitor(display, 0);
+
+    *area = {0, 0, 0, 0};
+    if (!monitor)
+        return;
+    gdk_monitor_get_geometry(monitor, area);
+    scale_area(area, gdk_monitor_get_scale_factor(monitor));
+}
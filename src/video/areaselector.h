@@ -0,0 +1,47 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef __AREA_SELECTOR_H__
+#define __AREA_SELECTOR_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/**
+ * The areas are in pixels of the root window, as shared by the daemon.
+ * `area' is null when the selection was cancelled.
+ */
+typedef void (*AreaSelectedCallback)(const GdkRectangle *area, gpointer user_data);
+
+/**
+ * Let the user draw the area of the screen to share, over all the monitors
+ * of the screen of `widget', without blocking the main loop. A click without
+ * drawing selects the monitor under it, Escape or another button cancels.
+ * `callback' is called exactly once.
+ */
+void area_selector_select(GtkWidget *widget, AreaSelectedCallback callback, gpointer user_data);
+
+/**
+ * The area of the monitor showing `widget'.
+ */
+void area_selector_get_monitor_area(GtkWidget *widget, GdkRectangle *area);
+
+G_END_DECLS
+
+#endif /* __AREA_SELECTOR_H__ */
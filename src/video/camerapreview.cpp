@@ -0,0 +1,112 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "camerapreview.h"
+
+#include <map>
+#include <string>
+
+// Lrc
+#include <api/avmodel.h>
+
+/* the preview is kept this long after the last view released it, many cameras
+ * taking hundreds of milliseconds to open */
+static constexpr guint PREVIEW_STOP_DELAY = 2000; /* milliseconds */
+
+namespace {
+
+struct Preview {
+    lrc::api::AVModel* avModel;
+    guint users;
+    bool started; // by the views, so stopped by them
+    guint stopSource;
+};
+
+// by resource
+std::map<std::string, Preview> previews;
+
+} // namespace
+
+static bool
+is_rendering(lrc::api::AVModel& avModel, const QString& resource)
+{
+    try {
+        return avModel.getRenderer(resource).isRendering();
+    } catch (const std::out_of_range&) {
+        return false;
+    }
+}
+
+static gboolean
+stop_preview(gpointer user_data)
+{
+    auto it = previews.find(static_cast<const gchar*>(user_data));
+    if (it == previews.end())
+        return G_SOURCE_REMOVE;
+
+    it->second.stopSource = 0;
+    if (it->second.users == 0) {
+        g_debug("stopping the camera preview %s", it->first.c_str());
+        it->second.avModel->stopPreview(QString::fromStdString(it->first));
+        previews.erase(it);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+gchar *
+camera_preview_acquire(lrc::api::AVModel& avModel)
+{
+    auto resource = "camera://" + avModel.getDefaultDevice();
+    auto& preview = previews[resource.toStdString()];
+    preview.avModel = &avModel;
+
+    if (preview.stopSource) {
+        // still running
+        g_source_remove(preview.stopSource);
+        preview.stopSource = 0;
+    } else if (preview.users == 0) {
+        preview.started = !is_rendering(avModel, resource);
+        if (preview.started) {
+            g_debug("starting the camera preview %s", qUtf8Printable(resource));
+            avModel.startPreview(resource);
+        }
+    }
+    ++preview.users;
+
+    return g_strdup(qUtf8Printable(resource));
+}
+
+void
+camera_preview_release(gchar **resource)
+{
+    if (!*resource)
+        return;
+
+    auto it = previews.find(*resource);
+    g_clear_pointer(resource, g_free);
+    if (it == previews.end() || it->second.users == 0 || --it->second.users > 0)
+        return;
+
+    if (!it->second.started) {
+        previews.erase(it);
+        return;
+    }
+    it->second.stopSource = g_timeout_add_full(G_PRIORITY_DEFAULT, PREVIEW_STOP_DELAY,
+                                               stop_preview, g_strdup(it->first.c_str()),
+                                               g_free);
+}
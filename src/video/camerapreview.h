@@ -0,0 +1,55 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef __CAMERA_PREVIEW_H__
+#define __CAMERA_PREVIEW_H__
+
+#include <gtk/gtk.h>
+
+namespace lrc
+{
+namespace api
+{
+    class AVModel;
+}
+}
+
+G_BEGIN_DECLS
+
+/**
+ * The preview of the camera shared by the views showing it, like the chat
+ * recorder, the avatar capture and the media settings. The views attach their
+ * VideoWidget to the renderer of the preview, which is started by the first
+ * view and stopped a moment after the last one released it, so going from a
+ * view to another one doesn't open the camera again.
+ */
+
+/**
+ * Use the preview of the default camera, started if it isn't running yet.
+ * Returns the resource to release, a new string.
+ */
+gchar *camera_preview_acquire(lrc::api::AVModel& avModel);
+/**
+ * Stop using the preview `*resource' acquired, if any; it is freed and set to
+ * null. A preview running before being acquired is left running.
+ */
+void   camera_preview_release(gchar **resource);
+
+G_END_DECLS
+
+#endif /* __CAMERA_PREVIEW_H__ */
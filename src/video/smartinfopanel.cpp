@@ -0,0 +1,376 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#include "smartinfopanel.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <glib/gi18n.h>
+
+// Lrc
+#include <smartinfohub.h>
+
+#include "video_widget.h"
+#include "../utils/calltelemetry.h"
+
+static constexpr guint SAMPLE_INTERVAL = 1; /* seconds */
+/* the samples kept for the export, an hour... */
+static constexpr size_t SESSION_SAMPLES = 3600 / SAMPLE_INTERVAL;
+/* ...and the ones drawn, a minute */
+static constexpr size_t GRAPH_SAMPLES = 60 / SAMPLE_INTERVAL;
+
+static constexpr gint LABEL_WIDTH = 180;
+static constexpr gint GRAPH_WIDTH = 120;
+static constexpr gint GRAPH_HEIGHT = 24;
+static constexpr gint GRAPH_SPACING = 6;
+
+namespace {
+
+struct Sample {
+    gint64 time; // real time, in microseconds
+    gfloat localFps;
+    gfloat remoteFps;
+    gint localWidth;
+    gint localHeight;
+    gint remoteWidth;
+    gint remoteHeight;
+    gfloat shownFps; // the frames of the peer shown by the client
+    gfloat renderTime; // to show a frame, in milliseconds
+};
+
+struct Graph {
+    const gchar* format; // of the name and the last value
+    gfloat (*value)(const Sample&);
+};
+
+const Graph GRAPHS[] = {
+    {N_("Peer framerate: %.1f"), [](const Sample& s) { return s.remoteFps; }},
+    {N_("Your framerate: %.1f"), [](const Sample& s) { return s.localFps; }},
+    {N_("Peer resolution: %.0fp"), [](const Sample& s) { return static_cast<gfloat>(s.remoteHeight); }},
+    {N_("Shown framerate: %.1f"), [](const Sample& s) { return s.shownFps; }},
+    {N_("Render time: %.2f ms"), [](const Sample& s) { return s.renderTime; }},
+};
+
+struct Field {
+    const gchar* name;
+    gdouble (*value)(const Sample&);
+};
+
+// exported, after the time
+const Field FIELDS[] = {
+    {"local_fps", [](const Sample& s) -> gdouble { return s.localFps; }},
+    {"remote_fps", [](const Sample& s) -> gdouble { return s.remoteFps; }},
+    {"local_width", [](const Sample& s) -> gdouble { return s.localWidth; }},
+    {"local_height", [](const Sample& s) -> gdouble { return s.localHeight; }},
+    {"remote_width", [](const Sample& s) -> gdouble { return s.remoteWidth; }},
+    {"remote_height", [](const Sample& s) -> gdouble { return s.remoteHeight; }},
+    {"shown_fps", [](const Sample& s) -> gdouble { return s.shownFps; }},
+    {"render_time_ms", [](const Sample& s) -> gdouble { return s.renderTime; }},
+};
+
+struct Panel {
+    GtkWidget* area;
+    GtkWidget* videoWidget; // weak
+    guint sampleSource {0};
+
+    // ring of the samples, the oldest at `first' once full
+    std::vector<Sample> samples;
+    size_t first {0};
+    std::string callId;
+
+    guint64 lastFrames {0};
+    gint64 lastRenderTime {0};
+    gint64 lastSampleTime {0};
+
+    size_t size() const { return samples.size(); }
+    const Sample& at(size_t i) const { return samples[(first + i) % samples.size()]; }
+    void push(const Sample& sample)
+    {
+        if (samples.size() < SESSION_SAMPLES) {
+            samples.push_back(sample);
+        } else {
+            samples[first] = sample;
+            first = (first + 1) % samples.size();
+        }
+    }
+};
+
+} // namespace
+
+static Panel*
+get_panel(GtkWidget* widget)
+{
+    return static_cast<Panel*>(g_object_get_data(G_OBJECT(widget), "smart-info-panel"));
+}
+
+static void
+free_panel(Panel* panel)
+{
+    if (panel->sampleSource)
+        g_source_remove(panel->sampleSource);
+    if (panel->videoWidget)
+        g_object_remove_weak_pointer(G_OBJECT(panel->videoWidget),
+                                     reinterpret_cast<gpointer*>(&panel->videoWidget));
+    delete panel;
+}
+
+static void
+get_render_stats(Panel* panel, guint64* frames, gint64* render_time)
+{
+    *frames = 0;
+    *render_time = 0;
+    if (panel->videoWidget)
+        video_widget_get_render_stats(VIDEO_WIDGET(panel->videoWidget), frames, render_time);
+}
+
+static gboolean
+sample_smart_info(Panel* panel)
+{
+    auto& hub = SmartInfoHub::instance();
+    // the view may show another call or a conference meanwhile
+    panel->callId = hub.callID().toStdString();
+
+    Sample sample;
+    sample.time = g_get_real_time();
+    sample.localFps = hub.localFps();
+    sample.remoteFps = hub.remoteFps();
+    sample.localWidth = hub.localWidth();
+    sample.localHeight = hub.localHeight();
+    sample.remoteWidth = hub.remoteWidth();
+    sample.remoteHeight = hub.remoteHeight();
+
+    guint64 frames;
+    gint64 renderTime;
+    get_render_stats(panel, &frames, &renderTime);
+    auto now = g_get_monotonic_time();
+    auto shown = frames - panel->lastFrames;
+    sample.shownFps = static_cast<gfloat>(shown * G_USEC_PER_SEC)
+                      / std::max<gint64>(now - panel->lastSampleTime, 1);
+    sample.renderTime = shown ? (renderTime - panel->lastRenderTime) / 1000.f / shown : 0;
+    panel->lastFrames = frames;
+    panel->lastRenderTime = renderTime;
+    panel->lastSampleTime = now;
+
+    panel->push(sample);
+    gtk_widget_queue_draw(panel->area);
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+on_map(G_GNUC_UNUSED GtkWidget* area, Panel* panel)
+{
+    // the frames shown while hidden aren't counted
+    get_render_stats(panel, &panel->lastFrames, &panel->lastRenderTime);
+    panel->lastSampleTime = g_get_monotonic_time();
+    if (!panel->sampleSource)
+        panel->sampleSource = g_timeout_add_seconds(SAMPLE_INTERVAL,
+                                                    (GSourceFunc)sample_smart_info,
+                                                    panel);
+}
+
+static void
+on_unmap(G_GNUC_UNUSED GtkWidget* area, Panel* panel)
+{
+    if (panel->sampleSource) {
+        g_source_remove(panel->sampleSource);
+        panel->sampleSource = 0;
+    }
+}
+
+static gboolean
+on_draw(GtkWidget* area, cairo_t* cr, Panel* panel)
+{
+    auto* context = gtk_widget_get_style_context(area);
+    GdkRGBA color;
+    gtk_style_context_get_color(context, gtk_style_context_get_state(context), &color);
+    gdk_cairo_set_source_rgba(cr, &color);
+    cairo_set_line_width(cr, 1);
+
+    auto count = std::min(panel->size(), GRAPH_SAMPLES);
+    auto offset = panel->size() - count;
+    auto right = gtk_widget_get_allocated_width(area) - 0.5;
+    auto step = static_cast<gdouble>(GRAPH_WIDTH) / (GRAPH_SAMPLES - 1);
+    auto* layout = gtk_widget_create_pango_layout(area, nullptr);
+
+    for (guint g = 0; g < G_N_ELEMENTS(GRAPHS); ++g) {
+        const auto& graph = GRAPHS[g];
+        auto top = g * (GRAPH_HEIGHT + GRAPH_SPACING);
+
+        auto last = count ? graph.value(panel->at(panel->size() - 1)) : 0.f;
+        auto* text = g_strdup_printf(_(graph.format), last);
+        pango_layout_set_text(layout, text, -1);
+        g_free(text);
+        cairo_move_to(cr, 0, top);
+        pango_cairo_show_layout(cr, layout);
+
+        if (count < 2)
+            continue;
+        auto max = 1.f;
+        for (size_t i = 0; i < count; ++i)
+            max = std::max(max, graph.value(panel->at(offset + i)));
+        // the last sample on the right
+        for (size_t i = 0; i < count; ++i) {
+            auto x = right - (count - 1 - i) * step;
+            auto y = top + GRAPH_HEIGHT - 0.5
+                     - graph.value(panel->at(offset + i)) / max * (GRAPH_HEIGHT - 1);
+            if (i == 0)
+                cairo_move_to(cr, x, y);
+            else
+                cairo_line_to(cr, x, y);
+        }
+        cairo_stroke(cr);
+    }
+
+    g_object_unref(layout);
+    return TRUE;
+}
+
+static void
+on_export_clicked(GtkWidget* panel_widget)
+{
+    auto* panel = get_panel(panel_widget);
+    GtkWindow* top_window = nullptr;
+    if (panel->videoWidget) {
+        auto* toplevel = gtk_widget_get_toplevel(panel->videoWidget);
+        if (GTK_IS_WINDOW(toplevel))
+            top_window = GTK_WINDOW(toplevel);
+    }
+
+    gchar* filename = nullptr;
+#if GTK_CHECK_VERSION(3,20,0)
+    GtkFileChooserNative *native = gtk_file_chooser_native_new(
+        _("Export Call Statistics"),
+        top_window,
+        GTK_FILE_CHOOSER_ACTION_SAVE,
+        _("_Save"),
+        _("_Cancel"));
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(native), TRUE);
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(native), "smartinfo.csv");
+
+    if (gtk_native_dialog_run(GTK_NATIVE_DIALOG(native)) == GTK_RESPONSE_ACCEPT)
+        filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(native));
+
+    g_object_unref(native);
+#else
+    GtkWidget *dialog = gtk_file_chooser_dialog_new(
+        _("Export Call Statistics"),
+        top_window,
+        GTK_FILE_CHOOSER_ACTION_SAVE,
+        _("_Cancel"), GTK_RESPONSE_CANCEL,
+        _("_Save"), GTK_RESPONSE_ACCEPT,
+        nullptr);
+    gtk_file_chooser_set_do_overwrite_confirmation(GTK_FILE_CHOOSER(dialog), TRUE);
+    gtk_file_chooser_set_current_name(GTK_FILE_CHOOSER(dialog), "smartinfo.csv");
+
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT)
+        filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+
+    gtk_widget_destroy(dialog);
+#endif
+
+    if (!filename)
+        return;
+    GError* error = nullptr;
+    if (!smart_info_panel_export(panel_widget, filename, &error)) {
+        g_warning("could not export the call statistics: %s", error->message);
+        g_error_free(error);
+    }
+    g_free(filename);
+}
+
+GtkWidget *
+smart_info_panel_new(GtkWidget *video_widget)
+{
+    auto* box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    auto* panel = new Panel;
+    panel->samples.reserve(SESSION_SAMPLES);
+    panel->videoWidget = video_widget;
+    if (video_widget)
+        g_object_add_weak_pointer(G_OBJECT(video_widget),
+                                  reinterpret_cast<gpointer*>(&panel->videoWidget));
+    g_object_set_data_full(G_OBJECT(box), "smart-info-panel", panel, (GDestroyNotify)free_panel);
+
+    panel->area = gtk_drawing_area_new();
+    gtk_widget_set_size_request(panel->area, LABEL_WIDTH + GRAPH_WIDTH,
+                                G_N_ELEMENTS(GRAPHS) * (GRAPH_HEIGHT + GRAPH_SPACING));
+    g_signal_connect(panel->area, "map", G_CALLBACK(on_map), panel);
+    g_signal_connect(panel->area, "unmap", G_CALLBACK(on_unmap), panel);
+    g_signal_connect(panel->area, "draw", G_CALLBACK(on_draw), panel);
+    gtk_box_pack_start(GTK_BOX(box), panel->area, FALSE, TRUE, 0);
+
+    auto* button_export = gtk_button_new_with_label(_("Export…"));
+    gtk_widget_set_halign(button_export, GTK_ALIGN_END);
+    g_signal_connect_swapped(button_export, "clicked", G_CALLBACK(on_export_clicked), box);
+    gtk_box_pack_start(GTK_BOX(box), button_export, FALSE, FALSE, 0);
+
+    gtk_widget_show_all(box);
+    return box;
+}
+
+static void
+append_number(GString* text, gdouble value)
+{
+    // not localized, the decimal separator must be a dot
+    gchar buffer[G_ASCII_DTOSTR_BUF_SIZE];
+    g_string_append(text, g_ascii_formatd(buffer, sizeof(buffer), "%.2f", value));
+}
+
+gboolean
+smart_info_panel_export(GtkWidget *panel_widget, const gchar *path, GError **error)
+{
+    auto* panel = get_panel(panel_widget);
+    g_return_val_if_fail(panel, FALSE);
+
+    GString* text = g_string_new(nullptr);
+    if (g_str_has_suffix(path, ".json")) {
+        auto* callId = json_string(panel->callId.c_str());
+        g_string_append_printf(text, "{\"callId\":%s,\"interval\":%u,\"samples\":[", callId, SAMPLE_INTERVAL);
+        g_free(callId);
+        for (size_t i = 0; i < panel->size(); ++i) {
+            const auto& sample = panel->at(i);
+            g_string_append_printf(text, "%s\n{\"time\":%" G_GINT64_FORMAT,
+                                   i ? "," : "", sample.time / 1000);
+            for (const auto& field : FIELDS) {
+                g_string_append_printf(text, ",\"%s\":", field.name);
+                append_number(text, field.value(sample));
+            }
+            g_string_append_c(text, '}');
+        }
+        g_string_append(text, "\n]}\n");
+    } else {
+        g_string_append(text, "time");
+        for (const auto& field : FIELDS)
+            g_string_append_printf(text, ",%s", field.name);
+        g_string_append_c(text, '\n');
+        for (size_t i = 0; i < panel->size(); ++i) {
+            const auto& sample = panel->at(i);
+            g_string_append_printf(text, "%" G_GINT64_FORMAT, sample.time / 1000);
+            for (const auto& field : FIELDS) {
+                g_string_append_c(text, ',');
+                append_number(text, field.value(sample));
+            }
+            g_string_append_c(text, '\n');
+        }
+    }
+
+    auto written = g_file_set_contents(path, text->str, text->len, error);
+    g_string_free(text, TRUE);
+    return written;
+}
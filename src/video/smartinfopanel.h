@@ -0,0 +1,42 @@
+/*
+ *  Copyright (C) 2022 Savoir-faire Linux Inc.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301 USA.
+ */
+
+#ifndef __SMART_INFO_PANEL_H__
+#define __SMART_INFO_PANEL_H__
+
+#include <gtk/gtk.h>
+
+G_BEGIN_DECLS
+
+/**
+ * The history of the SmartInfo of a call: the SmartInfoHub and the frames
+ * shown by `video_widget' are sampled at a fixed rate while the panel is
+ * mapped, and drawn as graphs of the last minute. Nothing is sampled nor drawn
+ * while it is hidden. The panel lets the user export the samples.
+ */
+GtkWidget *smart_info_panel_new(GtkWidget *video_widget);
+
+/**
+ * Write the samples of the session, as JSON if `path' ends with ".json" or
+ * as CSV otherwise.
+ */
+gboolean   smart_info_panel_export(GtkWidget *panel, const gchar *path, GError **error);
+
+G_END_DECLS
+
+#endif /* __SMART_INFO_PANEL_H__ */
@@ -20,8 +20,11 @@
 #include "video_widget.h"
 
 // std
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <mutex>
+#include <set>
 #include <string>
 
 // gtk
@@ -41,8 +44,10 @@
 
 // gnome client
 #include "../defines.h"
+#include "../utils/calltelemetry.h"
 #include "../utils/drawing.h"
-#include "xrectsel.h"
+#include "../utils/styleregistry.h"
+#include "areaselector.h"
 
 static constexpr int VIDEO_LOCAL_SIZE            = 150;
 static constexpr int VIDEO_LOCAL_OPACITY_DEFAULT = 255; /* out of 255 */
@@ -52,6 +57,14 @@ static constexpr const char* JOIN_CALL_KEY = "call_data";
  * use 30 ms (about 30 fps) since we don't expect to
  * receive video frames faster than that */
 static constexpr int FRAME_RATE_PERIOD           = 30;
+/* a check of the frames late by more than this is recorded as a stall of the
+ * main loop in the timeline of the call, and the peer sending no new frame
+ * for longer as a freeze of its video */
+static constexpr gint64 RENDER_STALL_THRESHOLD   = 250 * 1000; /* microseconds */
+
+/* the participant hovers under the pointer are searched in a grid of
+ * HOVERS_GRID * HOVERS_GRID cells over the video */
+static constexpr int HOVERS_GRID                 = 8;
 
 namespace { namespace details
 {
@@ -120,8 +133,13 @@ struct _VideoWidgetRenderer {
      * this will be set back to false once the black frame is rendered
      */
     std::atomic_bool         show_black_frame;
+    /* frames delivered by the renderer so far, and the last one rendered:
+     * currentFrame() returns the last frame again until a new one comes */
+    std::atomic<guint64>     frames;
+    guint64                  rendered_frame;
     QMetaObject::Connection  render_stop;
     QMetaObject::Connection  render_start;
+    QMetaObject::Connection  frame_update;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE(VideoWidget, video_widget, GTK_CLUTTER_TYPE_EMBED);
@@ -130,14 +148,45 @@ G_DEFINE_TYPE_WITH_PRIVATE(VideoWidget, video_widget, GTK_CLUTTER_TYPE_EMBED);
 
 namespace { namespace details {
 
+struct ParticipantHover
+{
+    ClutterActor* actor;
+    GtkWidget* label;
+    GtkWidget* options; // only for the moderators
+    QJsonObject infos;
+    gfloat x, y, w, h; // where it was placed
+    bool shown;
+};
+
 class CppImpl
 {
 public:
     explicit CppImpl(VideoWidget& widget) : self(&widget) {}
+    ~CppImpl() { g_clear_object(&moreIcon_); }
+
+    // hovers of the participants of the conference by uri, kept across the
+    // layout changes. They are placed again when the layout or the size of
+    // the video changed.
+    std::map<std::string, ParticipantHover> hovers_ {};
+    bool hoversMoved_ = false;
+    std::array<gfloat, 4> hoversGeometry_ {};
+    // the hovers overlapping each cell, filled when they are placed
+    std::array<std::vector<ParticipantHover*>, HOVERS_GRID * HOVERS_GRID> hoversGrid_ {};
+    gfloat hoversCellWidth_ = 0;
+    gfloat hoversCellHeight_ = 0;
+    std::vector<ParticipantHover*> hoversShown_ {};
+    GdkPixbuf* moreIcon_ = nullptr;
+
+    // the new frames of the peer shown so far and the time spent showing
+    // them, sampled by the SmartInfo
+    guint64 renderedFrames_ = 0;
+    gint64 renderTime_ = 0;
+    // the last check of the frames while the widget was visible
+    gint64 lastFrameCheck_ = 0;
+    // when the frames of the peer last changed, 0 while not rendering
+    gint64 lastNewFrame_ = 0;
+    guint64 framesSeen_ = 0;
 
-    std::mutex hoversMtx_ {};
-    std::map<std::string, ClutterActor*> hovers_ {};
-    std::map<std::string, QJsonObject> hoversInfos_ {};
     VideoWidget* self = nullptr; // The GTK widget itself
     AccountInfoPointer const *accountInfo = nullptr;
     QString callId {};
@@ -429,8 +478,9 @@ on_show_actions_popover(GtkButton *button, VideoWidget *self)
     auto call = callModel->getCall(priv->cpp->callId);
     auto isHost = call.type == lrc::api::call::Type::CONFERENCE;
     bool active = (bool)g_object_get_data(G_OBJECT(button), "active");
-    auto* uri = g_object_get_data(G_OBJECT(button), "uri");
-    g_object_set_data(G_OBJECT(priv->actions_popover), "uri", uri);
+    // the buttons of the popover share its copy, the hover may go meanwhile
+    auto* uri = g_strdup((gchar*)g_object_get_data(G_OBJECT(button), "uri"));
+    g_object_set_data_full(G_OBJECT(priv->actions_popover), "uri", uri, g_free);
     if (!isLocal && isHost) {
         auto* hangupBtn = gtk_button_new();
         gtk_button_set_label(GTK_BUTTON(hangupBtn), _("Hangup"));
@@ -518,45 +568,60 @@ on_show_actions_popover(GtkButton *button, VideoWidget *self)
     gtk_widget_show_all(priv->actions_popover);
 }
 
-void
-video_widget_add_participant_hover(VideoWidget *self, const QJsonObject& participant)
+static void
+set_participant_hover_infos(const ParticipantHover& hover, const QJsonObject& participant)
+{
+    std::vector<GObject*> objects {G_OBJECT(hover.actor)};
+    if (hover.options)
+        objects.emplace_back(G_OBJECT(hover.options));
+    for (auto* object : objects) {
+        g_object_set_data_full(object, "uri",
+                               (void*)g_strdup(qUtf8Printable(participant["uri"].toString())),
+                               g_free);
+        g_object_set_data(object, "isLocal", (void*)participant["isLocal"].toBool());
+        g_object_set_data(object, "active", (void*)participant["active"].toBool());
+    }
+}
+
+static ParticipantHover
+new_participant_hover(VideoWidget *self, const QJsonObject& participant, bool moderator)
 {
     VideoWidgetPrivate *priv = VIDEO_WIDGET_GET_PRIVATE(self);
     GtkStyleContext* context;
+    ParticipantHover hover {};
 
     auto stage = gtk_clutter_embed_get_stage(GTK_CLUTTER_EMBED(self));
     auto* box_participant = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
     auto* hover_participant = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 8);
-    auto* label_participant = gtk_label_new(participant["bestName"].toString().toLocal8Bit().constData());
-    gtk_label_set_xalign(GTK_LABEL(label_participant), 0);
-    gtk_box_pack_start(GTK_BOX(hover_participant), label_participant, TRUE, TRUE, 0);
-    gtk_widget_set_visible(GTK_WIDGET(label_participant), TRUE);
+    hover.label = gtk_label_new(participant["bestName"].toString().toLocal8Bit().constData());
+    gtk_label_set_xalign(GTK_LABEL(hover.label), 0);
+    gtk_box_pack_start(GTK_BOX(hover_participant), hover.label, TRUE, TRUE, 0);
+    gtk_widget_set_visible(GTK_WIDGET(hover.label), TRUE);
 
-    if ((*priv->cpp->accountInfo)->callModel->isModerator(priv->cpp->callId)) {
-        auto* options_btn = gtk_button_new();
+    if (moderator) {
+        hover.options = gtk_button_new();
 
-        GError *error = nullptr;
         auto image = gtk_image_new();
-        GdkPixbuf* optionsBuf = gdk_pixbuf_new_from_resource_at_scale("/net/jami/JamiGnome/more",
-                                                                    -1, 12, TRUE, &error);
-        if (!optionsBuf) {
-            g_debug("Could not load image: %s", error->message);
-            g_clear_error(&error);
-        } else
-            gtk_image_set_from_pixbuf(GTK_IMAGE(image), optionsBuf);
-
+        if (!priv->cpp->moreIcon_) {
+            GError *error = nullptr;
+            priv->cpp->moreIcon_ = gdk_pixbuf_new_from_resource_at_scale("/net/jami/JamiGnome/more",
+                                                                         -1, 12, TRUE, &error);
+            if (!priv->cpp->moreIcon_) {
+                g_debug("Could not load image: %s", error->message);
+                g_clear_error(&error);
+            }
+        }
+        if (priv->cpp->moreIcon_)
+            gtk_image_set_from_pixbuf(GTK_IMAGE(image), priv->cpp->moreIcon_);
 
-        gtk_button_set_relief(GTK_BUTTON(options_btn), GTK_RELIEF_NONE);
-        gtk_widget_set_tooltip_text(options_btn, _("More options"));
-        gtk_button_set_image(GTK_BUTTON(options_btn), image);
-        g_object_set_data(G_OBJECT(options_btn), "uri", (void*)g_strdup(qUtf8Printable(participant["uri"].toString())));
-        g_object_set_data(G_OBJECT(options_btn), "isLocal", (void*)participant["isLocal"].toBool());
-        g_object_set_data(G_OBJECT(options_btn), "active", (void*)participant["active"].toBool());
-        g_signal_connect(options_btn, "clicked", G_CALLBACK(on_show_actions_popover), self);
+        gtk_button_set_relief(GTK_BUTTON(hover.options), GTK_RELIEF_NONE);
+        gtk_widget_set_tooltip_text(hover.options, _("More options"));
+        gtk_button_set_image(GTK_BUTTON(hover.options), image);
+        g_signal_connect(hover.options, "clicked", G_CALLBACK(on_show_actions_popover), self);
 
-        gtk_box_pack_start(GTK_BOX(hover_participant), options_btn, FALSE, TRUE, 0);
-        gtk_widget_set_visible(GTK_WIDGET(options_btn), TRUE);
-        context = gtk_widget_get_style_context(options_btn);
+        gtk_box_pack_start(GTK_BOX(hover_participant), hover.options, FALSE, TRUE, 0);
+        gtk_widget_set_visible(GTK_WIDGET(hover.options), TRUE);
+        context = gtk_widget_get_style_context(hover.options);
         gtk_style_context_add_class(context, "options-btn");
     }
 
@@ -566,23 +631,110 @@ video_widget_add_participant_hover(VideoWidget *self, const QJsonObject& partici
 
     context = gtk_widget_get_style_context(hover_participant);
     gtk_style_context_add_class(context, "participant-hover");
-    context = gtk_widget_get_style_context(label_participant);
+    context = gtk_widget_get_style_context(hover.label);
     gtk_style_context_add_class(context, "label-hover");
-    auto* actor_info = gtk_clutter_actor_new_with_contents(GTK_WIDGET(box_participant));
+    hover.actor = gtk_clutter_actor_new_with_contents(GTK_WIDGET(box_participant));
 
-    g_object_set_data(G_OBJECT(actor_info), "uri", (void*)g_strdup(qUtf8Printable(participant["uri"].toString())));
-    g_object_set_data(G_OBJECT(actor_info), "isLocal", (void*)participant["isLocal"].toBool());
-    g_object_set_data(G_OBJECT(actor_info), "active", (void*)participant["active"].toBool());
+    clutter_actor_add_child(stage, hover.actor);
+    clutter_actor_set_y_align(hover.actor, CLUTTER_ACTOR_ALIGN_START);
+    clutter_actor_set_x_align(hover.actor, CLUTTER_ACTOR_ALIGN_START);
+    clutter_actor_hide(hover.actor);
 
-    clutter_actor_add_child(stage, actor_info);
-    clutter_actor_set_y_align(actor_info, CLUTTER_ACTOR_ALIGN_START);
-    clutter_actor_set_x_align(actor_info, CLUTTER_ACTOR_ALIGN_START);
-    {
-        std::lock_guard<std::mutex> lk(priv->cpp->hoversMtx_);
-        priv->cpp->hoversInfos_[participant["uri"].toString().toStdString()] = participant;
-        priv->cpp->hovers_[participant["uri"].toString().toStdString()] = actor_info;
+    set_participant_hover_infos(hover, participant);
+    hover.infos = participant;
+    return hover;
+}
+
+static int
+hovers_cell(gfloat position, gfloat cellSize)
+{
+    return std::clamp(static_cast<int>(position / cellSize), 0, HOVERS_GRID - 1);
+}
+
+static void
+clear_hovers_grid(VideoWidgetPrivate *priv)
+{
+    for (auto& cell : priv->cpp->hoversGrid_)
+        cell.clear();
+    priv->cpp->hoversCellWidth_ = 0;
+    priv->cpp->hoversCellHeight_ = 0;
+}
+
+static void
+fill_hovers_grid(VideoWidgetPrivate *priv, gfloat width, gfloat height)
+{
+    clear_hovers_grid(priv);
+    if (width <= 0 || height <= 0)
+        return;
+    auto cellWidth = width / HOVERS_GRID;
+    auto cellHeight = height / HOVERS_GRID;
+    for (auto& [uri, hover] : priv->cpp->hovers_) {
+        auto lastX = hovers_cell(hover.x + hover.w, cellWidth);
+        auto lastY = hovers_cell(hover.y + hover.h, cellHeight);
+        for (auto cellY = hovers_cell(hover.y, cellHeight); cellY <= lastY; ++cellY)
+            for (auto cellX = hovers_cell(hover.x, cellWidth); cellX <= lastX; ++cellX)
+                priv->cpp->hoversGrid_[cellY * HOVERS_GRID + cellX].emplace_back(&hover);
+    }
+    priv->cpp->hoversCellWidth_ = cellWidth;
+    priv->cpp->hoversCellHeight_ = cellHeight;
+}
+
+static std::map<std::string, ParticipantHover>::iterator
+erase_participant_hover(VideoWidgetPrivate *priv,
+                        std::map<std::string, ParticipantHover>::iterator it)
+{
+    auto& shown = priv->cpp->hoversShown_;
+    shown.erase(std::remove(shown.begin(), shown.end(), &it->second), shown.end());
+    // filled again when the hovers are placed
+    clear_hovers_grid(priv);
+    priv->cpp->hoversMoved_ = true;
+    clutter_actor_destroy(it->second.actor);
+    return priv->cpp->hovers_.erase(it);
+}
+
+void
+video_widget_update_participant_hovers(VideoWidget *self, const std::vector<QJsonObject>& participants)
+{
+    VideoWidgetPrivate *priv = VIDEO_WIDGET_GET_PRIVATE(self);
+    g_return_if_fail(priv && priv->cpp && priv->cpp->accountInfo);
+    auto& hovers = priv->cpp->hovers_;
+    auto moderator = (*priv->cpp->accountInfo)->callModel->isModerator(priv->cpp->callId);
+
+    std::set<std::string> uris;
+    for (const auto& participant : participants) {
+        auto uri = participant["uri"].toString().toStdString();
+        uris.emplace(uri);
+
+        auto it = hovers.find(uri);
+        if (it != hovers.end() && (it->second.options != nullptr) != moderator) {
+            // the options button comes and goes with the moderation
+            erase_participant_hover(priv, it);
+            it = hovers.end();
+        }
+        if (it == hovers.end()) {
+            hovers.emplace(uri, new_participant_hover(self, participant, moderator));
+            priv->cpp->hoversMoved_ = true;
+            continue;
+        }
+
+        auto& hover = it->second;
+        if (hover.infos == participant)
+            continue;
+        if (hover.infos.value("bestName") != participant["bestName"])
+            gtk_label_set_text(GTK_LABEL(hover.label),
+                               participant["bestName"].toString().toLocal8Bit().constData());
+        set_participant_hover_infos(hover, participant);
+        hover.infos = participant;
+        priv->cpp->hoversMoved_ = true;
+    }
+
+    // the participants gone
+    for (auto it = hovers.begin(); it != hovers.end();) {
+        if (uris.find(it->first) != uris.end())
+            ++it;
+        else
+            it = erase_participant_hover(priv, it);
     }
-    clutter_actor_hide(actor_info);
 }
 
 void
@@ -591,6 +743,9 @@ video_widget_set_call_info(VideoWidget *self, AccountInfoPointer const & account
     VideoWidgetPrivate *priv = VIDEO_WIDGET_GET_PRIVATE(self);
     if (not priv or not priv->cpp)
         return;
+    // the hovers are the ones of the previous call
+    if (priv->cpp->callId != callId)
+        video_widget_remove_hovers(self);
     priv->cpp->callId = callId;
     priv->cpp->accountInfo = &accountInfo;
 }
@@ -600,10 +755,10 @@ void
 video_widget_remove_hovers(VideoWidget *self)
 {
     VideoWidgetPrivate *priv = VIDEO_WIDGET_GET_PRIVATE(self);
-    std::lock_guard<std::mutex> lk(priv->cpp->hoversMtx_);
-    priv->cpp->hoversInfos_.clear();
-    for (const auto& [uri, actor]: priv->cpp->hovers_)
-        clutter_actor_destroy(actor);
+    clear_hovers_grid(priv);
+    priv->cpp->hoversShown_.clear();
+    for (const auto& [uri, hover]: priv->cpp->hovers_)
+        clutter_actor_destroy(hover.actor);
     priv->cpp->hovers_.clear();
 }
 
@@ -617,6 +772,8 @@ video_widget_on_event(VideoWidget *self, GdkEvent* event)
     // Ignore right click
     if (gdk_event_get_button(event, &button) && button == GDK_BUTTON_SECONDARY)
         return;
+    if (priv->cpp->hovers_.empty())
+        return;
 
     // HACK-HACK-HACK-HACK-HACK
     // https://gitlab.gnome.org/GNOME/clutter-gtk/-/issues/11
@@ -632,22 +789,42 @@ video_widget_on_event(VideoWidget *self, GdkEvent* event)
     int posX = dx - wx;
     int posY = dy - wy;
 
-    std::lock_guard<std::mutex> lk(priv->cpp->hoversMtx_);
-    for (const auto& [uri, actor]: priv->cpp->hovers_) {
-        if (!CLUTTER_IS_ACTOR(actor)) return;
-        gfloat x = clutter_actor_get_x(actor), y = clutter_actor_get_y(actor), w, h;
-        clutter_actor_get_size(actor, &w, &h);
-        if (posX >= x && posX <= x + w && posY >= y && posY <= y + h) {
-            // The mouse is in the hover
-            if (event->type == GDK_BUTTON_PRESS) {
-                // Let the button clickable without maximizing the participant
-                if (!(posX >= x + w - 12 && posY >= y + h - 12))
-                    on_maximize(G_OBJECT(actor), self);
-            }
-            clutter_actor_show(actor);
-        } else {
-            clutter_actor_hide(actor);
-        }
+    // The hovers under the mouse, from the cell of the grid
+    std::vector<ParticipantHover*> hovered;
+    auto cellWidth = priv->cpp->hoversCellWidth_;
+    auto cellHeight = priv->cpp->hoversCellHeight_;
+    if (cellWidth > 0 && cellHeight > 0 && posX >= 0 && posY >= 0) {
+        auto& cell = priv->cpp->hoversGrid_[hovers_cell(posY, cellHeight) * HOVERS_GRID
+                                            + hovers_cell(posX, cellWidth)];
+        for (auto* hover : cell)
+            if (posX >= hover->x && posX <= hover->x + hover->w
+                && posY >= hover->y && posY <= hover->y + hover->h)
+                hovered.emplace_back(hover);
+    }
+
+    // Only the hovers entered or left change
+    for (auto* hover : priv->cpp->hoversShown_) {
+        if (std::find(hovered.begin(), hovered.end(), hover) != hovered.end())
+            continue;
+        hover->shown = false;
+        clutter_actor_hide(hover->actor);
+    }
+    for (auto* hover : hovered) {
+        if (hover->shown)
+            continue;
+        hover->shown = true;
+        clutter_actor_show(hover->actor);
+    }
+    priv->cpp->hoversShown_ = hovered;
+
+    if (event->type == GDK_BUTTON_PRESS) {
+        std::vector<ClutterActor*> maximized;
+        for (auto* hover : hovered)
+            // Let the button clickable without maximizing the participant
+            if (!(posX >= hover->x + hover->w - 12 && posY >= hover->y + hover->h - 12))
+                maximized.emplace_back(hover->actor);
+        for (auto* actor : maximized)
+            on_maximize(G_OBJECT(actor), self);
     }
 }
 
@@ -766,6 +943,13 @@ void video_widget_on_drag_data_received(G_GNUC_UNUSED GtkWidget *self,
     g_strfreev(uris);
 }
 
+static void
+record_input_switch(VideoWidgetPrivate *priv, const gchar *input)
+{
+    if (call_telemetry_enabled() && priv->cpp)
+        call_telemetry_event(qUtf8Printable(priv->cpp->callId), "input", input);
+}
+
 static void
 switch_video_input(GtkWidget *widget, GtkWidget *parent)
 {
@@ -782,18 +966,16 @@ switch_video_input(GtkWidget *widget, GtkWidget *parent)
             return;
         }
         auto& callModel = (*priv->cpp->accountInfo)->callModel;
-        if (callModel)
+        if (callModel) {
             callModel->switchInputTo(device_id, priv->remote->v_renderer->getId());
+            record_input_switch(priv, qUtf8Printable(device_id));
+        }
     }
 }
 
-static void
-switch_video_input_screen_area(G_GNUC_UNUSED GtkWidget *item, GtkWidget *parent)
+static int
+current_display()
 {
-    auto* priv = VIDEO_WIDGET_GET_PRIVATE(parent);
-    unsigned x, y;
-    unsigned width, height;
-
     /* try to get the dispaly or default to 0 */
     QString display_env{getenv("DISPLAY")};
     int display = 0;
@@ -806,49 +988,48 @@ switch_video_input_screen_area(G_GNUC_UNUSED GtkWidget *item, GtkWidget *parent)
             g_debug("sharing screen from DISPLAY %d", display);
         }
     }
+    return display;
+}
 
-    x = y = width = height = 0;
-
-    xrectsel(&x, &y, &width, &height);
-
-    if (!width || !height) {
-        x = y = 0;
-        width = gdk_screen_width();
-        height = gdk_screen_height();
-    }
+static void
+share_screen_area(VideoWidget *self, const GdkRectangle& area)
+{
+    auto* priv = VIDEO_WIDGET_GET_PRIVATE(self);
+    if (!priv->cpp || !priv->cpp->accountInfo || !priv->remote->v_renderer)
+        return;
 
     auto& callModel = (*priv->cpp->accountInfo)->callModel;
-    if (callModel)
-        callModel->setDisplay(display, x, y, width, height, priv->remote->v_renderer->getId());
+    if (callModel) {
+        callModel->setDisplay(current_display(), area.x, area.y, area.width, area.height,
+                              priv->remote->v_renderer->getId());
+        auto* input = g_strdup_printf("display %dx%d+%d+%d", area.width, area.height, area.x, area.y);
+        record_input_switch(priv, input);
+        g_free(input);
+    }
 }
 
 static void
-switch_video_input_monitor(G_GNUC_UNUSED GtkWidget *item, GtkWidget *parent)
+on_screen_area_selected(const GdkRectangle *area, gpointer user_data)
 {
-    auto* priv = VIDEO_WIDGET_GET_PRIVATE(parent);
-    unsigned x, y;
-    unsigned width, height;
-
-    /* try to get the dispaly or default to 0 */
-    QString display_env{getenv("DISPLAY")};
-    int display = 0;
-
-    if (!display_env.isEmpty()) {
-        auto list = display_env.split(":", Qt::SkipEmptyParts);
-        /* should only be one display, so get the first one */
-        if (list.size() > 0) {
-            display = list.at(0).toInt();
-            g_debug("sharing screen from DISPLAY %d", display);
-        }
-    }
+    auto* self = VIDEO_WIDGET(user_data);
+    if (area)
+        share_screen_area(self, *area);
+    g_object_unref(self);
+}
 
-    x = y = 0;
-    width = gdk_screen_width();
-    height = gdk_screen_height();
+static void
+switch_video_input_screen_area(G_GNUC_UNUSED GtkWidget *item, GtkWidget *parent)
+{
+    // the call goes on while the area is drawn
+    area_selector_select(parent, on_screen_area_selected, g_object_ref(parent));
+}
 
-    auto& callModel = (*priv->cpp->accountInfo)->callModel;
-    if (callModel)
-        callModel->setDisplay(display, x, y, width, height, priv->remote->v_renderer->getId());
+static void
+switch_video_input_monitor(G_GNUC_UNUSED GtkWidget *item, GtkWidget *parent)
+{
+    GdkRectangle area;
+    area_selector_get_monitor_area(parent, &area);
+    share_screen_area(VIDEO_WIDGET(parent), area);
 }
 
 
@@ -878,6 +1059,7 @@ switch_video_input_file(G_GNUC_UNUSED GtkWidget *item, GtkWidget *parent)
         auto& callModel = (*priv->cpp->accountInfo)->callModel;
         if (uri && callModel) {
             callModel->setInputFile(uri, priv->remote->v_renderer->getId());
+            record_input_switch(priv, uri);
             g_free(uri);
         }
     }
@@ -896,6 +1078,7 @@ switch_video_input_file(G_GNUC_UNUSED GtkWidget *item, GtkWidget *parent)
         uri = gtk_file_chooser_get_uri(GTK_FILE_CHOOSER(dialog));
         if (uri && priv->avModel_) {
             priv->avModel_->setInputFile(uri, priv->remote->v_renderer->getId());
+            record_input_switch(priv, uri);
             g_free(uri);
         }
     }
@@ -991,11 +1174,11 @@ free_pixels(guchar *pixels, gpointer)
     g_free(pixels);
 }
 
-static void
+static bool
 clutter_render_image(VideoWidgetRenderer* wg_renderer, VideoWidgetPrivate* priv)
 {
     auto actor = wg_renderer->actor;
-    g_return_if_fail(CLUTTER_IS_ACTOR(actor));
+    g_return_val_if_fail(CLUTTER_IS_ACTOR(actor), false);
 
     if (wg_renderer->show_black_frame) {
         /* render a black frame set the bool back to false, this is likely done
@@ -1025,7 +1208,7 @@ clutter_render_image(VideoWidgetRenderer* wg_renderer, VideoWidgetPrivate* priv)
                         g_warning("error rendering empty image to clutter: %s", error->message);
                         g_clear_error(&error);
                         g_object_unref(image_empty);
-                        return;
+                        return false;
                     }
                     clutter_actor_set_content(actor, image_empty);
                     g_object_unref(image_empty);
@@ -1038,7 +1221,7 @@ clutter_render_image(VideoWidgetRenderer* wg_renderer, VideoWidgetPrivate* priv)
             }
         }
         wg_renderer->show_black_frame = false;
-        return;
+        return false;
     }
 
     ClutterContent *image_new = nullptr;
@@ -1049,14 +1232,14 @@ clutter_render_image(VideoWidgetRenderer* wg_renderer, VideoWidgetPrivate* priv)
         std::lock_guard<std::mutex> lock(wg_renderer->run_mutex);
 
         if (!wg_renderer->running)
-            return;
+            return false;
 
         if (!wg_renderer->v_renderer)
-            return;
+            return false;
 
         auto v_renderer = wg_renderer->v_renderer;
         if (!v_renderer)
-            return;
+            return false;
         auto frame = v_renderer->currentFrame();
 
         auto size = 0;
@@ -1076,10 +1259,10 @@ clutter_render_image(VideoWidgetRenderer* wg_renderer, VideoWidgetPrivate* priv)
                 std::move(frame.ptr, frame.ptr + size, priv->cpp->buffer.begin());
             }
         } else {
-            return;
+            return false;
         }
         image_new = clutter_image_new();
-        g_return_if_fail(image_new);
+        g_return_val_if_fail(image_new, false);
 
         const auto& res = v_renderer->size();
         gint BPP = 4; /* BGRA */
@@ -1098,7 +1281,7 @@ clutter_render_image(VideoWidgetRenderer* wg_renderer, VideoWidgetPrivate* priv)
             g_warning("error rendering image to clutter: %s", error->message);
             g_clear_error(&error);
             g_object_unref (image_new);
-            return;
+            return false;
         }
 
         if (wg_renderer->snapshot_status == HAS_TO_TAKE_ONE) {
@@ -1136,6 +1319,7 @@ clutter_render_image(VideoWidgetRenderer* wg_renderer, VideoWidgetPrivate* priv)
      * that the aspect ratio is correct
      */
     clutter_actor_set_content_gravity(actor, CLUTTER_CONTENT_GRAVITY_RESIZE_ASPECT);
+    return true;
 }
 
 static gboolean
@@ -1144,35 +1328,81 @@ check_frame_queue(VideoWidget *self)
     g_return_val_if_fail(IS_VIDEO_WIDGET(self), FALSE);
     VideoWidgetPrivate *priv = VIDEO_WIDGET_GET_PRIVATE(self);
 
-    if (!clutter_actor_get_paint_visibility(priv->video_container))
+    if (!clutter_actor_get_paint_visibility(priv->video_container)) {
+        priv->cpp->lastFrameCheck_ = 0;
+        priv->cpp->lastNewFrame_ = 0;
         return TRUE;
+    }
+
+    /* the frames of the peer weren't refreshed while the main loop was busy */
+    auto now = g_get_monotonic_time();
+    auto stalled = false;
+    if (priv->cpp->lastFrameCheck_ && priv->remote->running && call_telemetry_enabled()) {
+        auto late = now - priv->cpp->lastFrameCheck_ - FRAME_RATE_PERIOD * 1000;
+        stalled = late > RENDER_STALL_THRESHOLD;
+        if (stalled)
+            call_telemetry_mainloop_stall(qUtf8Printable(priv->cpp->callId), late);
+    }
+    priv->cpp->lastFrameCheck_ = now;
+
+    /* the peer sent no new frame for a while, recorded once it sends again */
+    auto frames = priv->remote->frames.load();
+    if (!priv->remote->running) {
+        priv->cpp->lastNewFrame_ = 0;
+    } else if (frames != priv->cpp->framesSeen_) {
+        auto frozen = priv->cpp->lastNewFrame_ ? now - priv->cpp->lastNewFrame_ : 0;
+        if (frozen > RENDER_STALL_THRESHOLD && !stalled && call_telemetry_enabled())
+            call_telemetry_video_frozen(qUtf8Printable(priv->cpp->callId), frozen);
+        priv->cpp->lastNewFrame_ = now;
+    }
+    priv->cpp->framesSeen_ = frames;
 
     /* display renderer's frames */
     if (priv->show_preview && priv->local)
         clutter_render_image(priv->local, priv);
-    clutter_render_image(priv->remote, priv);
+    auto start = g_get_monotonic_time();
+    if (clutter_render_image(priv->remote, priv) && frames != priv->remote->rendered_frame) {
+        priv->remote->rendered_frame = frames;
+        ++priv->cpp->renderedFrames_;
+        priv->cpp->renderTime_ += g_get_monotonic_time() - start;
+    }
 
     // HACK: https://gitlab.gnome.org/GNOME/clutter-gtk/-/issues/11
     // Because the CLUTTER_CONTENT_GRAVITY_RESIZE_ASPECT change the ratio of the widget inside the actor
     // and we can't get the real dimensions of the rendered renderer, we need to
     // re-calculate the real dimensions the actor has
-    if (priv->remote->actor && priv->remote->v_renderer) {
-        auto zoomX = priv->remote->v_renderer->size().rwidth() / clutter_actor_get_width(priv->remote->actor);
-        auto zoomY = priv->remote->v_renderer->size().rheight() / clutter_actor_get_height(priv->remote->actor);
-        auto zoom = std::max(zoomX, zoomY);
-        auto real_width = priv->remote->v_renderer->size().rwidth() / zoom;
-        auto real_height = priv->remote->v_renderer->size().rheight() / zoom;
-        auto offsetY = (clutter_actor_get_height(priv->remote->actor) - real_height) / 2;
-        auto offsetX = (clutter_actor_get_width(priv->remote->actor) - real_width) / 2;
-
-        std::lock_guard<std::mutex> lk(priv->cpp->hoversMtx_);
-        for (const auto& [uri, actor] : priv->cpp->hovers_) {
-            auto participant = priv->cpp->hoversInfos_[uri];
-
-            clutter_actor_set_height(actor, participant["h"].toInt() / zoom);
-            clutter_actor_set_width(actor, participant["w"].toInt() / zoom);
-            clutter_actor_set_x(actor, offsetX + participant["x"].toInt() / zoom);
-            clutter_actor_set_y(actor, offsetY + participant["y"].toInt() / zoom);
+    if (priv->remote->actor && priv->remote->v_renderer && !priv->cpp->hovers_.empty()) {
+        std::array<gfloat, 4> geometry {
+            static_cast<gfloat>(priv->remote->v_renderer->size().rwidth()),
+            static_cast<gfloat>(priv->remote->v_renderer->size().rheight()),
+            clutter_actor_get_width(priv->remote->actor),
+            clutter_actor_get_height(priv->remote->actor)
+        };
+        if (priv->cpp->hoversMoved_ || geometry != priv->cpp->hoversGeometry_) {
+            priv->cpp->hoversMoved_ = false;
+            priv->cpp->hoversGeometry_ = geometry;
+
+            auto zoomX = geometry[0] / geometry[2];
+            auto zoomY = geometry[1] / geometry[3];
+            auto zoom = std::max(zoomX, zoomY);
+            auto real_width = geometry[0] / zoom;
+            auto real_height = geometry[1] / zoom;
+            auto offsetY = (geometry[3] - real_height) / 2;
+            auto offsetX = (geometry[2] - real_width) / 2;
+
+            for (auto& [uri, hover] : priv->cpp->hovers_) {
+                const auto& participant = hover.infos;
+                hover.x = offsetX + participant["x"].toInt() / zoom;
+                hover.y = offsetY + participant["y"].toInt() / zoom;
+                hover.w = participant["w"].toInt() / zoom;
+                hover.h = participant["h"].toInt() / zoom;
+
+                clutter_actor_set_height(hover.actor, hover.h);
+                clutter_actor_set_width(hover.actor, hover.w);
+                clutter_actor_set_x(hover.actor, hover.x);
+                clutter_actor_set_y(hover.actor, hover.y);
+            }
+            fill_hovers_grid(priv, geometry[2], geometry[3]);
         }
     }
 
@@ -1213,6 +1443,7 @@ free_video_widget_renderer(VideoWidgetRenderer *renderer)
 {
     QObject::disconnect(renderer->render_stop);
     QObject::disconnect(renderer->render_start);
+    QObject::disconnect(renderer->frame_update);
     renderer_stop(renderer);
     if (renderer->snapshot)
         g_object_unref(renderer->snapshot);
@@ -1283,15 +1514,7 @@ video_widget_new(void)
     GtkWidget *self = (GtkWidget *)g_object_new(VIDEO_WIDGET_TYPE, NULL);
     auto* priv = VIDEO_WIDGET_GET_PRIVATE(self);
     // CSS styles
-    auto provider = gtk_css_provider_new();
-    std::string css = ".participant-hover { background: rgba(0,0,0,0.5); color: white; padding-left: 8; font-size: .8em;}\
-    .options-btn:hover {background: rgba(0,0,0,0); border: 0;} \
-    .options-btn {background: rgba(0,0,0,0); border: 0;} \
-    .label-hover { color: white; }";
-    gtk_css_provider_load_from_data(provider, css.c_str(), -1, nullptr);
-    gtk_style_context_add_provider_for_screen(gdk_display_get_default_screen(gdk_display_get_default()),
-                                              GTK_STYLE_PROVIDER(provider),
-                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+    style_registry_load("/net/jami/JamiGnome/css/videowidget.css");
     priv->cpp = new details::CppImpl(*VIDEO_WIDGET(self));
 
     return self;
@@ -1321,16 +1544,28 @@ video_widget_add_new_renderer(VideoWidget* self, lrc::api::AVModel* avModel,
         &*avModel,
         &lrc::api::AVModel::rendererStopped,
         [=](const QString& id) {
-            if (currentId == id)
+            if (currentId == id) {
                 renderer_stop(new_video_renderer);
+                call_telemetry_event(qUtf8Printable(id), "renderer-stopped", nullptr);
+            }
         });
 
     new_video_renderer->render_start = QObject::connect(
         &*avModel,
         &lrc::api::AVModel::rendererStarted,
         [=](const QString& id) {
-            if (currentId == id)
+            if (currentId == id) {
                 renderer_start(new_video_renderer);
+                call_telemetry_event(qUtf8Printable(id), "renderer-started", nullptr);
+            }
+        });
+
+    new_video_renderer->frame_update = QObject::connect(
+        &*avModel,
+        &lrc::api::AVModel::frameUpdated,
+        [=](const QString& id) {
+            if (currentId == id)
+                ++new_video_renderer->frames;
         });
 
     g_async_queue_push(priv->new_renderer_queue, new_video_renderer);
@@ -1347,6 +1582,16 @@ video_widget_get_renderer(VideoWidget* self, VideoRendererType type)
     return priv->local->v_renderer;
 }
 
+void
+video_widget_get_render_stats(VideoWidget *self, guint64 *frames, gint64 *render_time)
+{
+    g_return_if_fail(IS_VIDEO_WIDGET(self));
+    VideoWidgetPrivate *priv = VIDEO_WIDGET_GET_PRIVATE(self);
+
+    *frames = priv->cpp->renderedFrames_;
+    *render_time = priv->cpp->renderTime_;
+}
+
 void
 video_widget_take_snapshot(VideoWidget *self)
 {
@@ -25,6 +25,8 @@
 #include <api/newvideo.h>
 #include <QJsonObject>
 
+#include <vector>
+
 #include "../accountinfopointer.h"
 
 namespace lrc
@@ -57,6 +59,8 @@ GType           video_widget_get_type          (void) G_GNUC_CONST;
 GtkWidget*      video_widget_new               (void);
 void            video_widget_add_new_renderer (VideoWidget*, lrc::api::AVModel* avModel, const lrc::api::video::Renderer*, VideoRendererType);
 const lrc::api::video::Renderer* video_widget_get_renderer (VideoWidget*, VideoRendererType);
+/* the frames of the peer shown so far, and the time spent showing them in microseconds */
+void            video_widget_get_render_stats (VideoWidget *self, guint64 *frames, gint64 *render_time);
 void            video_widget_on_drag_data_received (GtkWidget *self,
                                                     GdkDragContext *context,
                                                     gint x,
@@ -71,7 +75,7 @@ gboolean        video_widget_on_button_press_in_screen_event (VideoWidget *self,
 void            video_widget_take_snapshot (VideoWidget *self);
 GdkPixbuf*      video_widget_get_snapshot  (VideoWidget *self);
 void            video_widget_set_preview_visible (VideoWidget *self, bool show);
-void            video_widget_add_participant_hover(VideoWidget *self, const QJsonObject& participant);
+void            video_widget_update_participant_hovers(VideoWidget *self, const std::vector<QJsonObject>& participants);
 void            video_widget_set_call_info(VideoWidget *self, AccountInfoPointer const & accountInfo, const QString& callId);
 void            video_widget_remove_hovers(VideoWidget *self);
 void            video_widget_on_event(VideoWidget *self, GdkEvent* event);
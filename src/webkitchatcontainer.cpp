@@ -22,6 +22,13 @@
 #include "webkitchatcontainer.h"
 
 #include "utils/drawing.h"
+#include "utils/startuptracer.h"
+
+// std
+#include <cstdio>
+#include <iterator>
+#include <map>
+#include <string>
 
 // GTK+ related
 #include <webkit2/webkit2.h>
@@ -60,6 +67,11 @@ struct _WebKitChatContainerPrivate
     /* Array of javascript libraries to load. Used during initialization */
     GList*     js_libs_to_load;
     gboolean   js_libs_loaded;
+
+    /* Windowed history, 0 when every loaded interaction stays displayed */
+    guint      resident_limit;
+    guint      resident_messages;
+    guint      dom_nodes;
 };
 
 G_DEFINE_TYPE_WITH_PRIVATE(WebKitChatContainer, webkit_chat_container, GTK_TYPE_BOX);
@@ -352,15 +364,23 @@ webview_script_dialog(WebKitWebView      *self,
                       G_GNUC_UNUSED gpointer user_data)
 {
     auto interaction = webkit_script_dialog_get_message(dialog);
+    if (g_str_has_prefix(interaction, "HISTORY_WINDOW_STATS:")) {
+        /* sent by JS_HISTORY_WINDOW each time it evicts messages */
+        WebKitChatContainerPrivate *priv = WEBKIT_CHAT_CONTAINER_GET_PRIVATE(self);
+        if (sscanf(interaction, "HISTORY_WINDOW_STATS:%u:%u", &priv->resident_messages, &priv->dom_nodes) == 2)
+            g_debug("chatview: %u messages displayed, %u DOM nodes", priv->resident_messages, priv->dom_nodes);
+        return true;
+    }
     g_signal_emit(G_OBJECT(self), webkit_chat_container_signals[SCRIPT_DIALOG], 0, interaction);
     return true;
 }
 
-static void
-init_js_i18n(WebKitChatContainer *view)
-{
-    gchar *function_call;
+/* name of the global holding the translations, set by the i18n user script */
+static constexpr const char* JS_I18N_VARIABLE = "jamiI18n";
 
+static std::string
+build_js_i18n()
+{
     auto translated = lrc::api::chatview::getTranslatedStrings(false);
     QJsonObject trjson;
     for (auto i = translated.begin(); i != translated.end(); ++i) {
@@ -370,18 +390,148 @@ init_js_i18n(WebKitChatContainer *view)
         }
     }
 
-    QJsonDocument doc(trjson);
-    QString strJson(doc.toJson(QJsonDocument::Compact));
-
-    if (strJson.isEmpty()) {
+    std::string script = std::string("window.") + JS_I18N_VARIABLE + " = ";
+    if (trjson.isEmpty()) {
         /* no translation available for current locale, use default */
-        function_call = g_strdup("init_i18n()");
+        script += "undefined;";
     } else {
-        function_call = g_strdup_printf("init_i18n(%s)", qUtf8Printable(strJson));
+        QJsonDocument doc(trjson);
+        script += doc.toJson(QJsonDocument::Compact).toStdString() + ";";
     }
+    return script;
+}
 
+/**
+ * The translations only depend on the locale, so they are serialized once per
+ * process and handed to every webview as a user script instead of being
+ * rebuilt on each load.
+ */
+static WebKitUserScript*
+get_js_i18n_script()
+{
+    /* one per locale, kept for the lifetime of the client */
+    static std::map<std::string, WebKitUserScript*> scripts;
+
+    std::string locale = g_get_language_names()[0];
+    auto it = scripts.find(locale);
+    if (it != scripts.end())
+        return it->second;
+
+    auto source = build_js_i18n();
+    auto* script = webkit_user_script_new(source.c_str(),
+                                          WEBKIT_USER_CONTENT_INJECT_TOP_FRAME,
+                                          WEBKIT_USER_SCRIPT_INJECT_AT_DOCUMENT_START,
+                                          nullptr,
+                                          nullptr);
+    scripts.emplace(locale, script);
+    return script;
+}
+
+/**
+ * Keeps at most jamiWindow.limit messages in the DOM. When there are too many,
+ * the ones farthest from the viewport are removed, and they are asked back to
+ * the client with PAGE_HISTORY when the user scrolls near an evicted end. While
+ * newer messages are evicted, addMessage is ignored: new messages are in the
+ * model and come back with the next page. recenter replaces the displayed
+ * messages with a window of the model, used to reach an evicted message.
+ */
+static constexpr const char* JS_HISTORY_WINDOW =
+    "(function() {"
+    "  if (window.jamiWindow) return;"
+    "  var w = window.jamiWindow = { limit: 0, olderEvicted: false, newerEvicted: false, pending: false, scheduled: false };"
+    "  var addMessageOrig = window.addMessage;"
+    "  window.addMessage = function(message) {"
+    "    if (w.newerEvicted) return;"
+    "    addMessageOrig.apply(this, arguments);"
+    "    w.schedule();"
+    "  };"
+    "  function list() { return document.getElementById(\"messages\"); }"
+    "  function scroller() {"
+    "    var l = list();"
+    "    return l && l.scrollHeight > l.clientHeight ? l : document.scrollingElement;"
+    "  }"
+    "  function resident() {"
+    "    var l = list();"
+    "    return l ? Array.prototype.filter.call(l.children, function(e) { return e.id; }) : [];"
+    "  }"
+    "  function idOf(e) { return e.id.replace(/^message_/, \"\"); }"
+    "  w.reset = function() { w.olderEvicted = w.newerEvicted = w.pending = false; };"
+    "  w.trim = function() {"
+    "    w.scheduled = false;"
+    "    var messages = resident();"
+    "    if (!w.limit || messages.length <= w.limit + w.limit / 10) return;"
+    "    var s = scroller();"
+    "    var first = 0;"
+    "    while (first < messages.length - 1 && messages[first].getBoundingClientRect().bottom < 0) ++first;"
+    "    var begin = Math.max(0, Math.min(first - Math.floor(w.limit / 2), messages.length - w.limit));"
+    "    var end = begin + w.limit;"
+    "    var height = s.scrollHeight;"
+    "    for (var i = 0; i < begin; ++i) messages[i].remove();"
+    "    s.scrollTop -= height - s.scrollHeight;"
+    "    for (var j = end; j < messages.length; ++j) messages[j].remove();"
+    "    w.olderEvicted = w.olderEvicted || begin > 0;"
+    "    w.newerEvicted = w.newerEvicted || end < messages.length;"
+    "    prompt(\"HISTORY_WINDOW_STATS:\" + resident().length + \":\" + document.getElementsByTagName(\"*\").length);"
+    "  };"
+    "  w.schedule = function() {"
+    "    if (!w.limit || w.scheduled) return;"
+    "    w.scheduled = true;"
+    "    requestAnimationFrame(w.trim);"
+    "  };"
+    "  w.restore = function(older, messages, complete, allLoaded) {"
+    "    if (older) {"
+    "      updateHistory(messages, allLoaded);"
+    "      w.olderEvicted = !complete;"
+    "    } else {"
+    "      messages.forEach(function(m) { addMessageOrig(m); });"
+    "      w.newerEvicted = !complete;"
+    "    }"
+    "    w.pending = false;"
+    "    w.schedule();"
+    "  };"
+    "  w.recenter = function(messages, older, newer, allLoaded) {"
+    "    clearMessages();"
+    "    updateHistory(messages, allLoaded);"
+    "    w.olderEvicted = older;"
+    "    w.newerEvicted = newer;"
+    "    w.pending = false;"
+    "    w.schedule();"
+    "  };"
+    "  w.onScroll = function() {"
+    "    w.schedule();"
+    "    if (w.pending) return;"
+    "    var s = scroller(), messages = resident();"
+    "    if (!messages.length) return;"
+    "    if (w.olderEvicted && s.scrollTop < s.clientHeight) {"
+    "      w.pending = true;"
+    "      prompt(\"PAGE_HISTORY:older:\" + idOf(messages[0]));"
+    "    } else if (w.newerEvicted && s.scrollHeight - s.scrollTop - s.clientHeight < s.clientHeight) {"
+    "      w.pending = true;"
+    "      prompt(\"PAGE_HISTORY:newer:\" + idOf(messages[messages.length - 1]));"
+    "    }"
+    "  };"
+    "  document.addEventListener(\"scroll\", w.onScroll, { capture: true, passive: true });"
+    "})();";
+
+static void
+apply_resident_limit(WebKitChatContainer *view)
+{
+    WebKitChatContainerPrivate *priv = WEBKIT_CHAT_CONTAINER_GET_PRIVATE(view);
+    if (priv->resident_limit == 0)
+        return;
+    webkit_chat_container_execute_js(view, JS_HISTORY_WINDOW);
+    gchar* function_call = g_strdup_printf("jamiWindow.limit = %u; jamiWindow.schedule();",
+                                           priv->resident_limit);
     webkit_chat_container_execute_js(view, function_call);
+    g_free(function_call);
+}
 
+static void
+init_js_i18n(WebKitChatContainer *view)
+{
+    /* the translations were injected with the page, see get_js_i18n_script */
+    gchar* function_call = g_strdup_printf("init_i18n(window.%s)", JS_I18N_VARIABLE);
+    webkit_chat_container_execute_js(view, function_call);
     g_free(function_call);
 }
 
@@ -423,8 +573,10 @@ javascript_library_loaded(WebKitWebView *webview_chat,
     {
          /* load translations before anything else */
          init_js_i18n(self);
+         apply_resident_limit(self);
 
          priv->js_libs_loaded = TRUE;
+         startup_tracer_mark("chatview ready");
          g_signal_emit(G_OBJECT(self), webkit_chat_container_signals[READY], 0);
 
          /* The view could now be deleted without causing a crash */
@@ -523,6 +675,7 @@ build_view(WebKitChatContainer *view)
 {
     g_return_if_fail(IS_WEBKIT_CHAT_CONTAINER(view));
     WebKitChatContainerPrivate *priv = WEBKIT_CHAT_CONTAINER_GET_PRIVATE(view);
+    startup_tracer_begin("webview creation");
 
     priv->chatview_debug = FALSE;
     auto chatview_debug = g_getenv("CHATVIEW_DEBUG");
@@ -598,6 +751,8 @@ build_view(WebKitChatContainer *view)
     );
     webkit_user_content_manager_add_style_sheet(webkit_content_manager, chatview_style_sheet);
 
+    webkit_user_content_manager_add_script(webkit_content_manager, get_js_i18n_script());
+
     /* Prepare WebKitSettings */
     WebKitSettings* webkit_settings = webkit_settings_new_with_settings(
         "enable-javascript", TRUE,
@@ -652,6 +807,7 @@ build_view(WebKitChatContainer *view)
 
     /* handle web view crash */
     g_signal_connect_swapped(priv->webview_chat, "web-process-crashed", G_CALLBACK(webview_crashed), view);
+    startup_tracer_end("webview creation");
 }
 
 static gboolean
@@ -703,7 +859,7 @@ webkit_chat_container_clear_sender_images(WebKitChatContainer *view)
 void
 webkit_chat_container_clear(WebKitChatContainer *view)
 {
-    webkit_chat_container_execute_js(view, "clearMessages();");
+    webkit_chat_container_execute_js(view, "clearMessages(); if (window.jamiWindow) jamiWindow.reset();");
     webkit_chat_container_clear_sender_images(view);
 }
 
@@ -769,6 +925,129 @@ webkit_chat_container_update_history(WebKitChatContainer *view,
     g_free(function_call);
 }
 
+void
+webkit_chat_container_page_history(WebKitChatContainer *view,
+                                   lrc::api::ConversationModel& conversation_model,
+                                   const QString& convId,
+                                   std::unique_ptr<lrc::api::MessageListModel>& interactions,
+                                   const QString& anchorId,
+                                   bool older,
+                                   int count,
+                                   bool all_loaded)
+{
+    auto begin = interactions->begin();
+    auto end = interactions->end();
+    auto anchor = interactions->find(anchorId);
+
+    QJsonArray array;
+    bool complete;
+    if (anchor == end) {
+        /* the anchor is gone, nothing sensible to page from */
+        complete = true;
+    } else if (older) {
+        auto first = anchor;
+        for (int i = 0; i < count && first != begin; ++i)
+            --first;
+        for (auto it = first; it != anchor; ++it)
+            array.append(build_interaction_json(conversation_model, convId, it->first, it->second));
+        complete = first == begin;
+    } else {
+        auto it = std::next(anchor);
+        for (int i = 0; i < count && it != end; ++i, ++it)
+            array.append(build_interaction_json(conversation_model, convId, it->first, it->second));
+        complete = it == end;
+    }
+
+    auto interactions_str = QJsonDocument(array).toJson(QJsonDocument::Compact);
+    /* Until the model start is displayed again, pretend everything is loaded
+     * so that chatview.js doesn't ask the daemon for older messages. */
+    gchar* function_call = g_strdup_printf("jamiWindow.restore(%s, %s, %s, %s)",
+                                           older ? "true" : "false",
+                                           interactions_str.constData(),
+                                           complete ? "true" : "false",
+                                           (all_loaded || !complete) ? "true" : "false");
+    webkit_chat_container_execute_js(view, function_call);
+    g_free(function_call);
+}
+
+void
+webkit_chat_container_page_around(WebKitChatContainer *view,
+                                  lrc::api::ConversationModel& conversation_model,
+                                  const QString& convId,
+                                  std::unique_ptr<lrc::api::MessageListModel>& interactions,
+                                  const QString& targetId,
+                                  int count,
+                                  bool all_loaded)
+{
+    auto begin = interactions->begin();
+    auto end = interactions->end();
+    auto target = interactions->find(targetId);
+    if (target == end)
+        return;
+
+    /* half a page on each side of the target */
+    auto first = target;
+    for (int i = 0; i < count / 2 && first != begin; ++i)
+        --first;
+    auto last = std::next(target);
+    for (int i = 0; i < count / 2 && last != end; ++i)
+        ++last;
+
+    QJsonArray array;
+    for (auto it = first; it != last; ++it)
+        array.append(build_interaction_json(conversation_model, convId, it->first, it->second));
+
+    /* without a resident limit the window is inert, but still pages the
+     * messages around the displayed ones back in when scrolling */
+    webkit_chat_container_execute_js(view, JS_HISTORY_WINDOW);
+    auto interactions_str = QJsonDocument(array).toJson(QJsonDocument::Compact);
+    gchar* function_call = g_strdup_printf("jamiWindow.recenter(%s, %s, %s, %s)",
+                                           interactions_str.constData(),
+                                           first != begin ? "true" : "false",
+                                           last != end ? "true" : "false",
+                                           (all_loaded || first != begin) ? "true" : "false");
+    webkit_chat_container_execute_js(view, function_call);
+    g_free(function_call);
+}
+
+void
+webkit_chat_container_set_resident_limit(WebKitChatContainer *view, guint limit)
+{
+    WebKitChatContainerPrivate *priv = WEBKIT_CHAT_CONTAINER_GET_PRIVATE(view);
+    if (priv->resident_limit == limit)
+        return;
+    priv->resident_limit = limit;
+    if (!priv->js_libs_loaded)
+        return; /* applied once the libraries are loaded */
+    if (limit == 0) {
+        webkit_chat_container_execute_js(view, "if (window.jamiWindow) jamiWindow.limit = 0;");
+        return;
+    }
+    apply_resident_limit(view);
+}
+
+void
+webkit_chat_container_scroll_to_interaction(WebKitChatContainer *view, const std::string& interactionId)
+{
+    /* chatview.js has no notion of search, so we drive the DOM directly.
+     * If the message is not displayed yet, ask the client to load more
+     * history, it will call us again once it is there. */
+    gchar* function_call = g_strdup_printf(
+        "(function() {"
+        "  var id = \"%s\";"
+        "  var message = document.getElementById(\"message_\" + id) || document.getElementById(id);"
+        "  if (!message) { prompt(\"SEARCH_RESULT_NOT_LOADED:\" + id); return; }"
+        "  message.scrollIntoView({block: \"center\"});"
+        "  var text = message.querySelector(\".message_text\") || message;"
+        "  text.style.transition = \"outline-color 1s\";"
+        "  text.style.outline = \"2px solid #3daee9\";"
+        "  setTimeout(function() { text.style.outlineColor = \"transparent\"; }, 1500);"
+        "})();",
+        interactionId.c_str());
+    webkit_chat_container_execute_js(view, function_call);
+    g_free(function_call);
+}
+
 void
 webkit_chat_container_set_invitation(WebKitChatContainer *view,
                                      bool show,
@@ -53,7 +53,11 @@ void       webkit_chat_container_update_interaction   (WebKitChatContainer *view
 void       webkit_chat_container_remove_interaction   (WebKitChatContainer *view, const QString& interactionId);
 void       webkit_chat_container_print_history        (WebKitChatContainer *view, lrc::api::ConversationModel& conversation_model, const QString& convId, std::unique_ptr<lrc::api::MessageListModel>& interactions);
 void       webkit_chat_container_update_history       (WebKitChatContainer *view, lrc::api::ConversationModel& conversation_model, const QString& convId, std::unique_ptr<lrc::api::MessageListModel>& interactions, bool all_loaded);
+void       webkit_chat_container_page_history         (WebKitChatContainer *view, lrc::api::ConversationModel& conversation_model, const QString& convId, std::unique_ptr<lrc::api::MessageListModel>& interactions, const QString& anchorId, bool older, int count, bool all_loaded);
+void       webkit_chat_container_page_around          (WebKitChatContainer *view, lrc::api::ConversationModel& conversation_model, const QString& convId, std::unique_ptr<lrc::api::MessageListModel>& interactions, const QString& targetId, int count, bool all_loaded);
+void       webkit_chat_container_set_resident_limit   (WebKitChatContainer *view, guint limit);
 void       webkit_chat_container_set_sender_image     (WebKitChatContainer *view, const std::string& sender, const std::string& senderImage);
+void       webkit_chat_container_scroll_to_interaction(WebKitChatContainer *view, const std::string& interactionId);
 gboolean   webkit_chat_container_is_ready             (WebKitChatContainer *view);
 void       webkit_chat_container_set_display_links    (WebKitChatContainer *view, bool display);
 void       webkit_chat_container_set_invitation       (WebKitChatContainer *view, bool show, const std::string& bestName, const std::string& bestId);